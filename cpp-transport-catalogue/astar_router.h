@@ -0,0 +1,125 @@
+#pragma once
+
+#include "graph.h"
+#include "priority_queues.h"
+#include "router.h"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//Point-to-point search guided by a potential: potential(vertex) is a lower bound
+//of the route weight from vertex to 'to'. The potential should be consistent
+//(potential(u) <= weight(u, v) + potential(v) for every edge), then every vertex is settled once
+//and the route is as short as the one of DijkstraRouter. A zero potential gives plain Dijkstra.
+//Scans the compressed sparse rows of the graph -> graph must be frozen.
+//Queue: a queue policy of priority_queues.h, RadixHeap needs a consistent potential
+template <typename Weight, typename Queue = BinaryHeap<Weight>>
+class AStarRouter {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    static constexpr Weight UNREACHABLE = WeightTraits<Weight>::UNREACHABLE;
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    explicit AStarRouter(const Graph& graph);
+
+    template <typename Potential>
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to, Potential&& potential) const;
+
+private:
+    void CheckVertex(VertexId vertex) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight, typename Queue>
+AStarRouter<Weight, Queue>::AStarRouter(const Graph& graph)
+    : graph_(graph)
+{
+    if (!graph_.IsFrozen()) {
+        throw std::logic_error("AStarRouter: graph should be frozen");
+    }
+    const Weight* weights = graph_.GetOutWeights();
+    for (size_t pos = 0; pos < graph_.GetEdgeCount(); ++pos) {
+        if (weights[pos] < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight, typename Queue>
+template <typename Potential>
+std::optional<typename AStarRouter<Weight, Queue>::RouteInfo> AStarRouter<Weight, Queue>::BuildRoute(VertexId from,
+                                                                                       VertexId to,
+                                                                                       Potential&& potential) const {
+    CheckVertex(from);
+    CheckVertex(to);
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    std::vector<Weight> weights(vertex_count, UNREACHABLE);
+    std::vector<EdgeId> prev_edges(vertex_count, NO_EDGE);
+    std::vector<bool> settled(vertex_count, false);
+    Queue queue(vertex_count);
+
+    const EdgeId* edge_ids = graph_.GetOutEdgeIds();
+    const VertexId* targets = graph_.GetOutTargets();
+    const Weight* edge_weights = graph_.GetOutWeights();
+
+    weights[from] = ZERO_WEIGHT;
+    queue.Push(potential(from), from);
+
+    while (!queue.Empty()) {
+        const VertexId vertex = queue.Pop().second;
+        //stale queue entry, vertex already reached with a smaller weight
+        if (settled[vertex]) {
+            continue;
+        }
+        settled[vertex] = true;
+        if (vertex == to) {
+            break;
+        }
+        const Weight weight = weights[vertex];
+        for (size_t pos = graph_.GetOutBegin(vertex), end = graph_.GetOutBegin(vertex + 1); pos < end; ++pos) {
+            const VertexId target = targets[pos];
+            const Weight candidate_weight = WeightTraits<Weight>::Add(weight, edge_weights[pos]);
+            if (candidate_weight < weights[target]) {
+                weights[target] = candidate_weight;
+                prev_edges[target] = edge_ids[pos];
+                queue.Push(WeightTraits<Weight>::Add(candidate_weight, potential(target)), target);
+            }
+        }
+    }
+
+    if (weights[to] == UNREACHABLE) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = prev_edges[to];
+         edge_id != NO_EDGE;
+         edge_id = prev_edges[graph_.GetEdge(edge_id).from])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{weights[to], std::move(edges)};
+}
+
+template <typename Weight, typename Queue>
+void AStarRouter<Weight, Queue>::CheckVertex(VertexId vertex) const {
+    if (vertex >= graph_.GetVertexCount()) {
+        throw std::out_of_range("AStarRouter: vertex id is out of range");
+    }
+}
+
+}  // namespace graph
@@ -0,0 +1,242 @@
+#include "city_generator.h"
+
+#include "../geo.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace bench {
+
+namespace {
+
+//splitmix64: tiny, fast & identical everywhere
+class Random {
+public:
+    explicit Random(uint64_t seed)
+    : state_(seed) {
+    }
+
+    uint64_t Next() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    //[0, bound), bound > 0
+    size_t Uniform(size_t bound) {
+        return static_cast<size_t>(Next() % bound);
+    }
+
+    //[0, 1)
+    double Real() {
+        return static_cast<double>(Next() >> 11) * 0x1.0p-53;
+    }
+
+private:
+    uint64_t state_ = 0;
+};
+
+std::string StopName(size_t stop) {
+    return "Stop "s + std::to_string(stop);
+}
+
+std::string BusName(size_t bus) {
+    return "Bus "s + std::to_string(bus);
+}
+
+//stops on a side x side grid, row-major, the last row may be incomplete
+class CityGrid {
+public:
+    CityGrid(size_t stop_count, Random& random)
+    : stop_count_(stop_count)
+    , side_(std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(1.0 * stop_count))))) {
+        //~30 km across, longitude degrees are shorter at this latitude
+        const double step = 0.27 / side_;
+        for(size_t stop = 0; stop < stop_count_; ++stop) {
+            const double row = stop / side_ + (random.Real() - 0.5) * 0.6;
+            const double col = stop % side_ + (random.Real() - 0.5) * 0.6;
+            coords_.push_back({55.6 + row * step, 37.4 + col * step * 1.8});
+        }
+    }
+
+    geo::Coord GetCoord(size_t stop) const {
+        return coords_[stop];
+    }
+
+    //next stop of a walk: a random grid neighbour, not going back unless stuck
+    size_t Step(size_t stop, size_t prev_stop, Random& random) const {
+        std::vector<size_t> neighbours;
+        const size_t row = stop / side_;
+        const size_t col = stop % side_;
+        if(row > 0) {
+            neighbours.push_back(stop - side_);
+        }
+        if(stop + side_ < stop_count_) {
+            neighbours.push_back(stop + side_);
+        }
+        if(col > 0) {
+            neighbours.push_back(stop - 1);
+        }
+        if(col + 1 < side_ && stop + 1 < stop_count_) {
+            neighbours.push_back(stop + 1);
+        }
+        if(neighbours.size() > 1) {
+            neighbours.erase(std::remove(neighbours.begin(), neighbours.end(), prev_stop), neighbours.end());
+        }
+        return neighbours.empty() ? stop : neighbours[random.Uniform(neighbours.size())];
+    }
+
+private:
+    size_t stop_count_ = 0;
+    size_t side_ = 1;
+    std::vector<geo::Coord> coords_;
+};
+
+json::Node MakeRenderSettings() {
+    return json::Map{
+        {"width"s, 1200.0},
+        {"height"s, 1200.0},
+        {"padding"s, 50.0},
+        {"line_width"s, 14.0},
+        {"stop_radius"s, 5.0},
+        {"bus_label_font_size"s, 20},
+        {"bus_label_offset"s, json::Array{7.0, 15.0}},
+        {"stop_label_font_size"s, 20},
+        {"stop_label_offset"s, json::Array{7.0, -3.0}},
+        {"underlayer_color"s, json::Array{255, 255, 255, 0.85}},
+        {"underlayer_width"s, 3.0},
+        {"color_palette"s, json::Array{"green"s, json::Array{255, 160, 0}, "red"s}},
+    };
+}
+
+json::Node MakeRoutingSettings(const CityConfig& config) {
+    return json::Map{
+        {"bus_wait_time"s, 6},
+        {"bus_velocity"s, 40.0},
+        {"router_type"s, config.router_type},
+        {"graph_model"s, config.graph_model},
+        {"router_threads"s, config.threads},
+    };
+}
+
+json::Array MakeStopNames(size_t count, size_t stop_count, Random& random) {
+    json::Array names;
+    for(size_t i = 0; i < count; ++i) {
+        names.push_back(StopName(random.Uniform(stop_count)));
+    }
+    return names;
+}
+
+json::Array MakeStatRequests(const CityConfig& config, Random& random) {
+    const RequestMix& mix = config.mix;
+    const size_t total_weight = mix.bus + mix.stop + mix.route + mix.reachable + mix.matrix;
+    json::Array requests;
+    int id = 1;
+    for(size_t i = 0; i < config.request_count && total_weight > 0; ++i, ++id) {
+        size_t pick = random.Uniform(total_weight);
+        if(pick < mix.bus) {
+            requests.push_back(json::Map{{"id"s, id}, {"type"s, "Bus"s},
+                                         {"name"s, BusName(random.Uniform(config.bus_count))}});
+        } else if((pick -= mix.bus) < mix.stop) {
+            requests.push_back(json::Map{{"id"s, id}, {"type"s, "Stop"s},
+                                         {"name"s, StopName(random.Uniform(config.stop_count))}});
+        } else if((pick -= mix.stop) < mix.route) {
+            requests.push_back(json::Map{{"id"s, id}, {"type"s, "Route"s},
+                                         {"from"s, StopName(random.Uniform(config.stop_count))},
+                                         {"to"s, StopName(random.Uniform(config.stop_count))}});
+        } else if((pick -= mix.route) < mix.reachable) {
+            requests.push_back(json::Map{{"id"s, id}, {"type"s, "Reachable"s},
+                                         {"name"s, StopName(random.Uniform(config.stop_count))},
+                                         {"max_time"s, config.reachable_minutes}});
+        } else {
+            requests.push_back(json::Map{{"id"s, id}, {"type"s, "Matrix"s},
+                                         {"sources"s, MakeStopNames(config.matrix_size, config.stop_count, random)},
+                                         {"targets"s, MakeStopNames(config.matrix_size, config.stop_count, random)}});
+        }
+    }
+    for(size_t i = 0; i < config.map_requests; ++i, ++id) {
+        requests.push_back(json::Map{{"id"s, id}, {"type"s, "Map"s}});
+    }
+    return requests;
+}
+
+}  // namespace
+
+json::Document GenerateCity(const CityConfig& config) {
+    if(config.stop_count == 0 || config.bus_count == 0 || config.route_length < 2) {
+        throw std::invalid_argument("GenerateCity: a city needs stops & buses of at least 2 stops");
+    }
+    Random random(config.seed);
+    const CityGrid grid(config.stop_count, random);
+
+    //road distances by (from, to), std::map -> stable output order
+    std::map<std::pair<size_t, size_t>, int> road_distances;
+    auto add_road_distance = [&](size_t from, size_t to) {
+        const double geo_distance = geo::ComputeDistance(grid.GetCoord(from), grid.GetCoord(to));
+        road_distances.insert({{from, to}, static_cast<int>(std::lround(geo_distance * (1.1 + 0.4 * random.Real()))) + 1});
+    };
+
+    json::Array base_requests;
+    for(size_t bus = 0; bus < config.bus_count; ++bus) {
+        std::vector<size_t> stops{random.Uniform(config.stop_count)};
+        size_t prev_stop = stops.front();
+        while(stops.size() < config.route_length) {
+            const size_t next_stop = grid.Step(stops.back(), prev_stop, random);
+            prev_stop = stops.back();
+            stops.push_back(next_stop);
+        }
+        const bool is_roundtrip = random.Uniform(10) < 3;
+        if(is_roundtrip) {
+            stops.push_back(stops.front());
+        }
+        json::Array stop_names;
+        for(size_t i = 0; i < stops.size(); ++i) {
+            stop_names.push_back(StopName(stops[i]));
+            if(i > 0) {
+                add_road_distance(stops[i - 1], stops[i]);
+                //the way back is sometimes longer (one-way streets)
+                if(!is_roundtrip && random.Uniform(4) == 0) {
+                    add_road_distance(stops[i], stops[i - 1]);
+                }
+            }
+        }
+        base_requests.push_back(json::Map{
+            {"type"s, "Bus"s},
+            {"name"s, BusName(bus)},
+            {"stops"s, std::move(stop_names)},
+            {"is_roundtrip"s, is_roundtrip},
+        });
+    }
+
+    std::vector<json::Map> stop_distances(config.stop_count);
+    for(const auto& [stops, distance] : road_distances) {
+        stop_distances[stops.first][StopName(stops.second)] = distance;
+    }
+    for(size_t stop = 0; stop < config.stop_count; ++stop) {
+        base_requests.push_back(json::Map{
+            {"type"s, "Stop"s},
+            {"name"s, StopName(stop)},
+            {"latitude"s, grid.GetCoord(stop).lat},
+            {"longitude"s, grid.GetCoord(stop).lng},
+            {"road_distances"s, std::move(stop_distances[stop])},
+        });
+    }
+
+    return json::Document{json::Map{
+        {"base_requests"s, std::move(base_requests)},
+        {"render_settings"s, MakeRenderSettings()},
+        {"routing_settings"s, MakeRoutingSettings(config)},
+        {"processing_settings"s, json::Map{{"threads"s, config.threads}}},
+        {"stat_requests"s, MakeStatRequests(config, random)},
+    }};
+}
+
+}  // namespace bench
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../json.h"
+
+#include <cstdint>
+#include <string>
+
+namespace bench {
+
+//relative weights of generated stat request types
+struct RequestMix {
+    size_t bus = 10;
+    size_t stop = 10;
+    size_t route = 78;
+    size_t reachable = 1;
+    size_t matrix = 1;
+};
+
+struct CityConfig {
+    size_t stop_count = 1000;
+    size_t bus_count = 100;
+    //stops of a bus as given in base_requests, before the way back of non-roundtrip buses
+    size_t route_length = 20;
+    size_t request_count = 10000;
+    RequestMix mix;
+    //Map requests, rendered once each
+    size_t map_requests = 1;
+    size_t matrix_size = 20;
+    double reachable_minutes = 30.0;
+    uint64_t seed = 1;
+    //routing_settings overrides, json router_type / graph_model values
+    std::string router_type = "dijkstra";
+    std::string graph_model = "stop_pairs";
+    //processing_settings.threads & router_threads, 0 = all cores
+    int threads = 1;
+};
+
+//Whole input document: base_requests, render_settings, routing_settings & stat_requests.
+//Stops on a jittered grid, buses are random walks between neighbouring stops,
+//road distances are geo distances stretched by 10-50%. Same config -> same document
+//(own random generator, no implementation-defined std distributions)
+json::Document GenerateCity(const CityConfig& config);
+
+}  // namespace bench
@@ -0,0 +1,173 @@
+#include "city_generator.h"
+
+#include "../json_reader.h"
+#include "../map_renderer.h"
+#include "../request_handler.h"
+#include "../transport_catalogue.h"
+#include "../transport_router.h"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: transport_catalogue_benchmark [--option=value]...\n"
+              "  --stops=1000 --buses=100 --route_length=20 --requests=10000 --seed=1\n"
+              "  --mix=bus:10,stop:10,route:78,reachable:1,matrix:1 --maps=1 --matrix_size=20\n"
+              "  --router_type=dijkstra --graph_model=stop_pairs --threads=1\n"
+              "  --dump=file.json  write the generated input & exit\n"sv;
+}
+
+//peak resident set size of the process so far, MiB
+double GetPeakRssMb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    //kilobytes on Linux
+    return usage.ru_maxrss / 1024.0;
+}
+
+//Runs & reports one pipeline phase
+double RunPhase(std::string_view name, const std::function<void()>& phase) {
+    const auto start = std::chrono::steady_clock::now();
+    phase();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-16s %10.3f s %10.1f MiB peak RSS\n", std::string(name).c_str(), seconds, GetPeakRssMb());
+    return seconds;
+}
+
+bench::RequestMix ParseMix(std::string_view mix_str) {
+    bench::RequestMix mix{0, 0, 0, 0, 0};
+    while(!mix_str.empty()) {
+        const auto item = mix_str.substr(0, mix_str.find(','));
+        mix_str.remove_prefix(std::min(mix_str.size(), item.size() + 1));
+        const auto colon = item.find(':');
+        if(colon == std::string_view::npos) {
+            throw std::invalid_argument("mix item without weight: "s + std::string(item));
+        }
+        const auto type = item.substr(0, colon);
+        const size_t weight = std::stoul(std::string(item.substr(colon + 1)));
+        if(type == "bus"sv) {
+            mix.bus = weight;
+        } else if(type == "stop"sv) {
+            mix.stop = weight;
+        } else if(type == "route"sv) {
+            mix.route = weight;
+        } else if(type == "reachable"sv) {
+            mix.reachable = weight;
+        } else if(type == "matrix"sv) {
+            mix.matrix = weight;
+        } else {
+            throw std::invalid_argument("unknown request type in mix: "s + std::string(type));
+        }
+    }
+    return mix;
+}
+
+}  // namespace
+
+//Generates a city, then runs the whole JsonReader -> TransportDb -> BusRouter -> MapRenderer pipeline
+//on it, phase by phase. The router is built in a phase of its own, before the stat requests
+int main(int argc, char* argv[]) {
+    bench::CityConfig config;
+    std::string dump_file;
+    try {
+        for(int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const auto eq = arg.find('=');
+            if(arg.substr(0, 2) != "--"sv || eq == std::string_view::npos) {
+                PrintUsage();
+                return 1;
+            }
+            const auto key = arg.substr(2, eq - 2);
+            const std::string value(arg.substr(eq + 1));
+            if(key == "stops"sv) {
+                config.stop_count = std::stoul(value);
+            } else if(key == "buses"sv) {
+                config.bus_count = std::stoul(value);
+            } else if(key == "route_length"sv) {
+                config.route_length = std::stoul(value);
+            } else if(key == "requests"sv) {
+                config.request_count = std::stoul(value);
+            } else if(key == "seed"sv) {
+                config.seed = std::stoull(value);
+            } else if(key == "mix"sv) {
+                config.mix = ParseMix(value);
+            } else if(key == "maps"sv) {
+                config.map_requests = std::stoul(value);
+            } else if(key == "matrix_size"sv) {
+                config.matrix_size = std::stoul(value);
+            } else if(key == "router_type"sv) {
+                config.router_type = value;
+            } else if(key == "graph_model"sv) {
+                config.graph_model = value;
+            } else if(key == "threads"sv) {
+                config.threads = std::stoi(value);
+            } else if(key == "dump"sv) {
+                dump_file = value;
+            } else {
+                PrintUsage();
+                return 1;
+            }
+        }
+    } catch(const std::exception& ex) {
+        std::cerr << "Bad argument: " << ex.what() << '\n';
+        PrintUsage();
+        return 1;
+    }
+
+    std::string input;
+    RunPhase("generate", [&] {
+        std::ostringstream out;
+        json::Print(bench::GenerateCity(config), out);
+        input = std::move(out).str();
+    });
+    if(!dump_file.empty()) {
+        std::ofstream(dump_file) << input;
+        return 0;
+    }
+
+    TransportDb database;
+    MapRenderer map_renderer;
+    BusRouter router(database);
+    RequestHandler request_handler(database, map_renderer, router);
+    JsonReader jreader(database, request_handler);
+
+    std::string answers;
+    double total_seconds = 0.0;
+    double requests_seconds = 0.0;
+    total_seconds += RunPhase("parse_input", [&] {
+        std::istringstream in(input);
+        jreader.ParseInput(in);
+    });
+    total_seconds += RunPhase("router_build", [&] {
+        router.Build();
+    });
+    requests_seconds = RunPhase("stat_requests", [&] {
+        jreader.ProcessStatRequests();
+    });
+    total_seconds += requests_seconds;
+    total_seconds += RunPhase("print_answers", [&] {
+        std::ostringstream out;
+        jreader.PrintRequestAnswers(out);
+        answers = std::move(out).str();
+    });
+
+    const size_t request_count = config.request_count + config.map_requests;
+    std::printf("%-16s %10.3f s\n", "pipeline", total_seconds);
+    std::printf("input %.1f MiB, answers %.1f MiB, %zu requests, %.0f requests/s\n",
+                input.size() / 1048576.0, answers.size() / 1048576.0, request_count,
+                requests_seconds > 0 ? request_count / requests_seconds : 0.0);
+    return 0;
+}
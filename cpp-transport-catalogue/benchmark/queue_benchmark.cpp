@@ -0,0 +1,136 @@
+#include "city_generator.h"
+
+#include "../json_reader.h"
+#include "../map_renderer.h"
+#include "../request_handler.h"
+#include "../transport_catalogue.h"
+#include "../transport_router.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: transport_catalogue_queue_benchmark [--option=value]...\n"
+              "  --stops=1000 --buses=100 --route_length=20 --seed=1 --graph_model=stop_pairs\n"
+              "  --searches=200  full single-source searches per queue\n"sv;
+}
+
+//BusRouter graph with weights in minutes * units_in_minute, rounded for integer weights
+template <typename Weight>
+graph::DirectedWeightedGraph<Weight> ConvertGraph(const BusRouter::Graph& source, double units_in_minute) {
+    graph::DirectedWeightedGraph<Weight> result(source.GetVertexCount());
+    for(graph::EdgeId edge_id = 0; edge_id < source.GetEdgeCount(); ++edge_id) {
+        const auto& edge = source.GetEdge(edge_id);
+        const double weight = edge.weight / BusRouter::WEIGHT_UNITS_IN_MINUTE * units_in_minute;
+        result.AddEdge({edge.from, edge.to,
+                        static_cast<Weight>(std::is_integral_v<Weight> ? std::round(weight) : weight)});
+    }
+    result.Freeze();
+    return result;
+}
+
+//Times full trees from every source, the checksum (sum of reached weights) must not depend on the queue
+template <typename Weight, typename Queue>
+void RunQueue(std::string_view name, const graph::DirectedWeightedGraph<Weight>& bus_graph,
+              const std::vector<graph::VertexId>& sources) {
+    const graph::DijkstraRouter<Weight, Queue> router(bus_graph);
+    double checksum = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    for(const auto source : sources) {
+        const auto tree = router.BuildTree(source);
+        for(const Weight weight : tree.weights) {
+            if(weight != router.UNREACHABLE) {
+                checksum += weight;
+            }
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-24s %10.3f ms/search %20.0f checksum\n", std::string(name).c_str(),
+                sources.empty() ? 0.0 : seconds * 1000.0 / sources.size(), checksum);
+}
+
+}  // namespace
+
+//Dijkstra queue policies on the graph BusRouter builds for a synthetic city:
+//double minutes & uint32 hundredths of a minute
+int main(int argc, char* argv[]) {
+    bench::CityConfig config;
+    config.request_count = 0;
+    config.map_requests = 0;
+    size_t search_count = 200;
+    try {
+        for(int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const auto eq = arg.find('=');
+            if(arg.substr(0, 2) != "--"sv || eq == std::string_view::npos) {
+                PrintUsage();
+                return 1;
+            }
+            const auto key = arg.substr(2, eq - 2);
+            const std::string value(arg.substr(eq + 1));
+            if(key == "stops"sv) {
+                config.stop_count = std::stoul(value);
+            } else if(key == "buses"sv) {
+                config.bus_count = std::stoul(value);
+            } else if(key == "route_length"sv) {
+                config.route_length = std::stoul(value);
+            } else if(key == "seed"sv) {
+                config.seed = std::stoull(value);
+            } else if(key == "graph_model"sv) {
+                config.graph_model = value;
+            } else if(key == "searches"sv) {
+                search_count = std::stoul(value);
+            } else {
+                PrintUsage();
+                return 1;
+            }
+        }
+    } catch(const std::exception& ex) {
+        std::cerr << "Bad argument: " << ex.what() << '\n';
+        PrintUsage();
+        return 1;
+    }
+
+    TransportDb database;
+    MapRenderer map_renderer;
+    BusRouter router(database);
+    RequestHandler request_handler(database, map_renderer, router);
+    JsonReader jreader(database, request_handler);
+    {
+        std::ostringstream out;
+        json::Print(bench::GenerateCity(config), out);
+        std::istringstream in(std::move(out).str());
+        jreader.ParseInput(in);
+    }
+    router.Build();
+
+    const auto minutes_graph = ConvertGraph<double>(router.GetGraph(), 1.0);
+    const auto centiminutes_graph = ConvertGraph<uint32_t>(router.GetGraph(), 100.0);
+    const size_t vertex_count = minutes_graph.GetVertexCount();
+    std::printf("%zu vertices, %zu edges, %zu searches\n", vertex_count, minutes_graph.GetEdgeCount(), search_count);
+    if(vertex_count == 0) {
+        return 0;
+    }
+    std::vector<graph::VertexId> sources;
+    for(size_t i = 0; i < search_count; ++i) {
+        //spread over the vertices, same for every queue
+        sources.push_back(i * 7919 % vertex_count);
+    }
+
+    RunQueue<double, graph::BinaryHeap<double>>("binary, double", minutes_graph, sources);
+    RunQueue<double, graph::QuaternaryHeap<double>>("4-ary, double", minutes_graph, sources);
+    RunQueue<uint32_t, graph::BinaryHeap<uint32_t>>("binary, uint32", centiminutes_graph, sources);
+    RunQueue<uint32_t, graph::QuaternaryHeap<uint32_t>>("4-ary, uint32", centiminutes_graph, sources);
+    RunQueue<uint32_t, graph::RadixHeap<uint32_t>>("radix, uint32", centiminutes_graph, sources);
+    return 0;
+}
@@ -0,0 +1,393 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//Contraction Hierarchies: vertices are contracted one by one in order of importance
+//(edge difference + contracted neighbours), shortcuts keep shortest distances between the remaining
+//vertices. Queries are a bidirectional Dijkstra over arcs leading to higher ranked vertices only,
+//shortcuts are unpacked back into the original EdgeIds of the graph
+template <typename Weight>
+class ContractionHierarchy {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    explicit ContractionHierarchy(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    size_t GetShortcutCount() const {
+        return arcs_.size() - graph_.GetEdgeCount();
+    }
+
+private:
+    static constexpr Weight UNREACHABLE = WeightTraits<Weight>::UNREACHABLE;
+    static constexpr EdgeId NO_ARC = std::numeric_limits<EdgeId>::max();
+    //witness searches give up after settling this many vertices -> the shortcut is kept
+    static constexpr size_t WITNESS_SETTLED_LIMIT = 500;
+
+    //Original edges keep their EdgeId as arc id, shortcuts are appended after them
+    //and replace the two arcs first_child + second_child
+    struct Arc {
+        VertexId from = 0;
+        VertexId to = 0;
+        Weight weight{};
+        EdgeId first_child = NO_ARC;
+        EdgeId second_child = NO_ARC;
+    };
+
+    struct ContractionState {
+        std::vector<std::vector<EdgeId>> out_arcs;
+        std::vector<std::vector<EdgeId>> in_arcs;
+        std::vector<bool> contracted;
+        std::vector<int> contracted_neighbours;
+        //witness search scratch, reset after every search
+        std::vector<Weight> witness_weights;
+        std::vector<VertexId> touched;
+    };
+
+    using Shortcuts = std::vector<Arc>;
+    struct Contraction {
+        Shortcuts shortcuts;
+        //arcs to & from not yet contracted neighbours
+        int removed_arcs = 0;
+    };
+    using QueueItem = std::pair<Weight, VertexId>;
+    using MinQueue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    void Preprocess();
+    Contraction FindShortcuts(ContractionState& state, VertexId vertex) const;
+    //cheapest arc per neighbour, contracted neighbours & vertex itself skipped
+    std::vector<EdgeId> GetBestArcs(const ContractionState& state, const std::vector<EdgeId>& arcs,
+                                    VertexId vertex, bool outgoing) const;
+    void WitnessSearch(ContractionState& state, VertexId source, VertexId avoid, Weight max_weight) const;
+    void ResetWitnessSearch(ContractionState& state) const;
+    void BuildSearchGraphs();
+    void UnpackArc(EdgeId arc_id, std::vector<EdgeId>& edges) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    std::vector<Arc> arcs_;
+    std::vector<size_t> ranks_;
+    //forward search: arcs from a vertex to higher ranked ones, [up_offsets_[v], up_offsets_[v + 1])
+    std::vector<size_t> up_offsets_;
+    std::vector<EdgeId> up_arcs_;
+    //backward search: arcs from higher ranked vertices into a vertex
+    std::vector<size_t> down_offsets_;
+    std::vector<EdgeId> down_arcs_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : graph_(graph)
+{
+    arcs_.reserve(graph_.GetEdgeCount());
+    for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        arcs_.push_back({edge.from, edge.to, edge.weight, NO_ARC, NO_ARC});
+    }
+    Preprocess();
+    BuildSearchGraphs();
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Preprocess() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    ContractionState state;
+    state.out_arcs.resize(vertex_count);
+    state.in_arcs.resize(vertex_count);
+    state.contracted.assign(vertex_count, false);
+    state.contracted_neighbours.assign(vertex_count, 0);
+    state.witness_weights.assign(vertex_count, UNREACHABLE);
+
+    for (EdgeId arc_id = 0; arc_id < arcs_.size(); ++arc_id) {
+        const Arc& arc = arcs_[arc_id];
+        //self-loops never shorten a route
+        if (arc.from != arc.to) {
+            state.out_arcs[arc.from].push_back(arc_id);
+            state.in_arcs[arc.to].push_back(arc_id);
+        }
+    }
+
+    //edge difference + contracted neighbours, the latter spreads contraction evenly over the graph
+    auto get_priority = [&](VertexId vertex, const Contraction& contraction) {
+        return static_cast<int>(contraction.shortcuts.size()) - contraction.removed_arcs
+             + state.contracted_neighbours[vertex];
+    };
+
+    using PriorityItem = std::pair<int, VertexId>;
+    std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        queue.push({get_priority(vertex, FindShortcuts(state, vertex)), vertex});
+    }
+
+    ranks_.assign(vertex_count, 0);
+    size_t next_rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+
+        //lazy update: priorities of the remaining vertices change as neighbours are contracted
+        const Contraction contraction = FindShortcuts(state, vertex);
+        const int priority = get_priority(vertex, contraction);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.push({priority, vertex});
+            continue;
+        }
+
+        for (const Arc& shortcut : contraction.shortcuts) {
+            const EdgeId arc_id = arcs_.size();
+            arcs_.push_back(shortcut);
+            state.out_arcs[shortcut.from].push_back(arc_id);
+            state.in_arcs[shortcut.to].push_back(arc_id);
+        }
+        state.contracted[vertex] = true;
+        ranks_[vertex] = next_rank++;
+
+        for (const EdgeId arc_id : state.in_arcs[vertex]) {
+            ++state.contracted_neighbours[arcs_[arc_id].from];
+        }
+        for (const EdgeId arc_id : state.out_arcs[vertex]) {
+            ++state.contracted_neighbours[arcs_[arc_id].to];
+        }
+    }
+}
+
+template <typename Weight>
+std::vector<EdgeId> ContractionHierarchy<Weight>::GetBestArcs(const ContractionState& state,
+                                                              const std::vector<EdgeId>& arcs,
+                                                              VertexId vertex, bool outgoing) const {
+    auto neighbour = [&](EdgeId arc_id) {
+        return outgoing ? arcs_[arc_id].to : arcs_[arc_id].from;
+    };
+    std::vector<EdgeId> best_arcs;
+    for (const EdgeId arc_id : arcs) {
+        const VertexId other = neighbour(arc_id);
+        if (other != vertex && !state.contracted[other]) {
+            best_arcs.push_back(arc_id);
+        }
+    }
+    //cheapest arc first for every neighbour, then drop the rest
+    std::sort(best_arcs.begin(), best_arcs.end(), [&](EdgeId lhs, EdgeId rhs) {
+        return std::pair{neighbour(lhs), arcs_[lhs].weight} < std::pair{neighbour(rhs), arcs_[rhs].weight};
+    });
+    best_arcs.erase(std::unique(best_arcs.begin(), best_arcs.end(), [&](EdgeId lhs, EdgeId rhs) {
+        return neighbour(lhs) == neighbour(rhs);
+    }), best_arcs.end());
+    return best_arcs;
+}
+
+template <typename Weight>
+typename ContractionHierarchy<Weight>::Contraction ContractionHierarchy<Weight>::FindShortcuts(ContractionState& state,
+                                                                                               VertexId vertex) const {
+    const auto in_arcs = GetBestArcs(state, state.in_arcs[vertex], vertex, false);
+    const auto out_arcs = GetBestArcs(state, state.out_arcs[vertex], vertex, true);
+    Contraction contraction;
+    contraction.removed_arcs = static_cast<int>(in_arcs.size() + out_arcs.size());
+    if (in_arcs.empty() || out_arcs.empty()) {
+        return contraction;
+    }
+    Weight max_out_weight = ZERO_WEIGHT;
+    for (const EdgeId out_arc : out_arcs) {
+        max_out_weight = std::max(max_out_weight, arcs_[out_arc].weight);
+    }
+
+    for (const EdgeId in_arc : in_arcs) {
+        const VertexId source = arcs_[in_arc].from;
+        WitnessSearch(state, source, vertex, WeightTraits<Weight>::Add(arcs_[in_arc].weight, max_out_weight));
+
+        for (const EdgeId out_arc : out_arcs) {
+            const VertexId target = arcs_[out_arc].to;
+            if (target == source) {
+                continue;
+            }
+            //a path avoiding vertex, which is not longer, makes the shortcut unnecessary
+            const Weight shortcut_weight = WeightTraits<Weight>::Add(arcs_[in_arc].weight, arcs_[out_arc].weight);
+            if (shortcut_weight < state.witness_weights[target]) {
+                contraction.shortcuts.push_back({source, target, shortcut_weight, in_arc, out_arc});
+            }
+        }
+        ResetWitnessSearch(state);
+    }
+    return contraction;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::WitnessSearch(ContractionState& state, VertexId source,
+                                                 VertexId avoid, Weight max_weight) const {
+    MinQueue queue;
+    state.witness_weights[source] = ZERO_WEIGHT;
+    state.touched.push_back(source);
+    queue.push({ZERO_WEIGHT, source});
+
+    size_t settled_count = 0;
+    while (!queue.empty() && settled_count < WITNESS_SETTLED_LIMIT) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weight > state.witness_weights[vertex]) {
+            continue;
+        }
+        if (max_weight < weight) {
+            break;
+        }
+        ++settled_count;
+        for (const EdgeId arc_id : state.out_arcs[vertex]) {
+            const Arc& arc = arcs_[arc_id];
+            if (arc.to == avoid || state.contracted[arc.to]) {
+                continue;
+            }
+            const Weight candidate_weight = WeightTraits<Weight>::Add(weight, arc.weight);
+            if (candidate_weight < state.witness_weights[arc.to]) {
+                if (state.witness_weights[arc.to] == UNREACHABLE) {
+                    state.touched.push_back(arc.to);
+                }
+                state.witness_weights[arc.to] = candidate_weight;
+                queue.push({candidate_weight, arc.to});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::ResetWitnessSearch(ContractionState& state) const {
+    for (const VertexId vertex : state.touched) {
+        state.witness_weights[vertex] = UNREACHABLE;
+    }
+    state.touched.clear();
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildSearchGraphs() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    std::vector<std::vector<EdgeId>> up_lists(vertex_count);
+    std::vector<std::vector<EdgeId>> down_lists(vertex_count);
+    for (EdgeId arc_id = 0; arc_id < arcs_.size(); ++arc_id) {
+        const Arc& arc = arcs_[arc_id];
+        if (ranks_[arc.from] < ranks_[arc.to]) {
+            up_lists[arc.from].push_back(arc_id);
+        } else if (ranks_[arc.from] > ranks_[arc.to]) {
+            down_lists[arc.to].push_back(arc_id);
+        }
+    }
+
+    auto pack = [vertex_count](const std::vector<std::vector<EdgeId>>& lists,
+                               std::vector<size_t>& offsets, std::vector<EdgeId>& arcs) {
+        offsets.assign(vertex_count + 1, 0);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            offsets[vertex] = arcs.size();
+            arcs.insert(arcs.end(), lists[vertex].begin(), lists[vertex].end());
+        }
+        offsets[vertex_count] = arcs.size();
+    };
+    pack(up_lists, up_offsets_, up_arcs_);
+    pack(down_lists, down_offsets_, down_arcs_);
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(VertexId from,
+                                                                                                         VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("ContractionHierarchy: vertex id is out of range");
+    }
+
+    //index 0 - forward search from 'from', 1 - backward search from 'to'
+    std::vector<Weight> weights[2] = {std::vector<Weight>(vertex_count, UNREACHABLE),
+                                      std::vector<Weight>(vertex_count, UNREACHABLE)};
+    std::vector<EdgeId> parent_arcs[2] = {std::vector<EdgeId>(vertex_count, NO_ARC),
+                                          std::vector<EdgeId>(vertex_count, NO_ARC)};
+    MinQueue queues[2];
+
+    weights[0][from] = ZERO_WEIGHT;
+    weights[1][to] = ZERO_WEIGHT;
+    queues[0].push({ZERO_WEIGHT, from});
+    queues[1].push({ZERO_WEIGHT, to});
+
+    Weight best_weight = from == to ? ZERO_WEIGHT : UNREACHABLE;
+    VertexId meeting_vertex = from;
+
+    auto is_active = [&](int side) {
+        return !queues[side].empty() && queues[side].top().first < best_weight;
+    };
+    while (is_active(0) || is_active(1)) {
+        const int side = !is_active(1) || (is_active(0) && queues[0].top() < queues[1].top()) ? 0 : 1;
+        const auto [weight, vertex] = queues[side].top();
+        queues[side].pop();
+        if (weight > weights[side][vertex]) {
+            continue;
+        }
+        const Weight through_weight = WeightTraits<Weight>::Add(weight, weights[1 - side][vertex]);
+        if (through_weight < best_weight) {
+            best_weight = through_weight;
+            meeting_vertex = vertex;
+        }
+
+        const auto& offsets = side == 0 ? up_offsets_ : down_offsets_;
+        const auto& arcs = side == 0 ? up_arcs_ : down_arcs_;
+        for (size_t pos = offsets[vertex]; pos < offsets[vertex + 1]; ++pos) {
+            const Arc& arc = arcs_[arcs[pos]];
+            const VertexId next = side == 0 ? arc.to : arc.from;
+            const Weight candidate_weight = WeightTraits<Weight>::Add(weight, arc.weight);
+            if (candidate_weight < weights[side][next]) {
+                weights[side][next] = candidate_weight;
+                parent_arcs[side][next] = arcs[pos];
+                queues[side].push({candidate_weight, next});
+            }
+        }
+    }
+
+    if (best_weight == UNREACHABLE) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> arcs;
+    for (VertexId vertex = meeting_vertex; parent_arcs[0][vertex] != NO_ARC; vertex = arcs_[parent_arcs[0][vertex]].from) {
+        arcs.push_back(parent_arcs[0][vertex]);
+    }
+    std::reverse(arcs.begin(), arcs.end());
+    for (VertexId vertex = meeting_vertex; parent_arcs[1][vertex] != NO_ARC; vertex = arcs_[parent_arcs[1][vertex]].to) {
+        arcs.push_back(parent_arcs[1][vertex]);
+    }
+
+    std::vector<EdgeId> edges;
+    for (const EdgeId arc_id : arcs) {
+        UnpackArc(arc_id, edges);
+    }
+    return RouteInfo{best_weight, std::move(edges)};
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackArc(EdgeId arc_id, std::vector<EdgeId>& edges) const {
+    //explicit stack: shortcuts of long routes can be nested deeply
+    std::vector<EdgeId> stack = {arc_id};
+    while (!stack.empty()) {
+        const Arc& arc = arcs_[stack.back()];
+        if (arc.first_child == NO_ARC) {
+            edges.push_back(stack.back());
+            stack.pop_back();
+            continue;
+        }
+        stack.pop_back();
+        stack.push_back(arc.second_child);
+        stack.push_back(arc.first_child);
+    }
+}
+
+}  // namespace graph
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "graph.h"
+#include "priority_queues.h"
+#include "router.h"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//On-demand alternative to Router: no precompute, one heap-based
+//single-source Dijkstra per BuildRoute call, stopped as soon as 'to' is settled.
+//Scans the compressed sparse rows of the graph -> graph must be frozen.
+//Queue: a queue policy of priority_queues.h
+template <typename Weight, typename Queue = BinaryHeap<Weight>>
+class DijkstraRouter {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    static constexpr Weight UNREACHABLE = WeightTraits<Weight>::UNREACHABLE;
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    //Distances & incoming tree edges from source to every vertex,
+    //UNREACHABLE / NO_EDGE for vertices which are not reached
+    struct ShortestPathTree {
+        VertexId source = 0;
+        std::vector<Weight> weights;
+        std::vector<EdgeId> prev_edges;
+
+        size_t GetSizeBytes() const {
+            return sizeof(*this) + weights.size() * sizeof(Weight) + prev_edges.size() * sizeof(EdgeId);
+        }
+    };
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    //Full single-source search, result can be reused for any destination
+    ShortestPathTree BuildTree(VertexId from) const;
+    //Search stopped at max_weight: farther vertices are left UNREACHABLE
+    ShortestPathTree BuildTree(VertexId from, Weight max_weight) const;
+    //Path reconstruction only
+    std::optional<RouteInfo> BuildRoute(const ShortestPathTree& tree, VertexId to) const;
+
+private:
+    //stops as soon as 'to' is settled, if given, never goes beyond max_weight
+    ShortestPathTree Search(VertexId from, std::optional<VertexId> to, Weight max_weight = UNREACHABLE) const;
+    void CheckVertex(VertexId vertex) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight, typename Queue>
+DijkstraRouter<Weight, Queue>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    if (!graph_.IsFrozen()) {
+        throw std::logic_error("DijkstraRouter: graph should be frozen");
+    }
+    const Weight* weights = graph_.GetOutWeights();
+    for (size_t pos = 0; pos < graph_.GetEdgeCount(); ++pos) {
+        if (weights[pos] < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight, typename Queue>
+std::optional<typename DijkstraRouter<Weight, Queue>::RouteInfo> DijkstraRouter<Weight, Queue>::BuildRoute(VertexId from,
+                                                                                             VertexId to) const {
+    CheckVertex(to);
+    return BuildRoute(Search(from, to), to);
+}
+
+template <typename Weight, typename Queue>
+typename DijkstraRouter<Weight, Queue>::ShortestPathTree DijkstraRouter<Weight, Queue>::BuildTree(VertexId from) const {
+    return Search(from, std::nullopt);
+}
+
+template <typename Weight, typename Queue>
+typename DijkstraRouter<Weight, Queue>::ShortestPathTree DijkstraRouter<Weight, Queue>::BuildTree(VertexId from,
+                                                                                    Weight max_weight) const {
+    return Search(from, std::nullopt, max_weight);
+}
+
+template <typename Weight, typename Queue>
+std::optional<typename DijkstraRouter<Weight, Queue>::RouteInfo> DijkstraRouter<Weight, Queue>::BuildRoute(const ShortestPathTree& tree,
+                                                                                             VertexId to) const {
+    CheckVertex(to);
+    if (tree.weights[to] == UNREACHABLE) {
+        return std::nullopt;
+    }
+    const Weight weight = tree.weights[to];
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = tree.prev_edges[to];
+         edge_id != NO_EDGE;
+         edge_id = tree.prev_edges[graph_.GetEdge(edge_id).from])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight, typename Queue>
+typename DijkstraRouter<Weight, Queue>::ShortestPathTree DijkstraRouter<Weight, Queue>::Search(VertexId from,
+                                                                                 std::optional<VertexId> to,
+                                                                                 Weight max_weight) const {
+    CheckVertex(from);
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    ShortestPathTree tree{from,
+                          std::vector<Weight>(vertex_count, UNREACHABLE),
+                          std::vector<EdgeId>(vertex_count, NO_EDGE)};
+    std::vector<bool> settled(vertex_count, false);
+    Queue queue(vertex_count);
+
+    const EdgeId* edge_ids = graph_.GetOutEdgeIds();
+    const VertexId* targets = graph_.GetOutTargets();
+    const Weight* edge_weights = graph_.GetOutWeights();
+
+    tree.weights[from] = ZERO_WEIGHT;
+    queue.Push(ZERO_WEIGHT, from);
+
+    while (!queue.Empty()) {
+        const auto [weight, vertex] = queue.Pop();
+        //stale queue entry, vertex already reached with a smaller weight
+        if (settled[vertex]) {
+            continue;
+        }
+        settled[vertex] = true;
+        if (vertex == to) {
+            break;
+        }
+        for (size_t pos = graph_.GetOutBegin(vertex), end = graph_.GetOutBegin(vertex + 1); pos < end; ++pos) {
+            const VertexId target = targets[pos];
+            const Weight candidate_weight = WeightTraits<Weight>::Add(weight, edge_weights[pos]);
+            if (candidate_weight < tree.weights[target] && !(max_weight < candidate_weight)) {
+                tree.weights[target] = candidate_weight;
+                tree.prev_edges[target] = edge_ids[pos];
+                queue.Push(candidate_weight, target);
+            }
+        }
+    }
+    return tree;
+}
+
+template <typename Weight, typename Queue>
+void DijkstraRouter<Weight, Queue>::CheckVertex(VertexId vertex) const {
+    if (vertex >= graph_.GetVertexCount()) {
+        throw std::out_of_range("DijkstraRouter: vertex id is out of range");
+    }
+}
+
+}  // namespace graph
@@ -1,7 +1,11 @@
 #pragma once
 #include "geo.h"
 
+#include <cstdint>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <set>
 #include <variant>
 #include <vector>
@@ -21,21 +25,24 @@ inline bool IsZero(double value) {
 }
 
 //======================= Stop & Bus =======================//
+//Stops, buses & their stop lists live in the arena of TransportDb, names in its string pool,
+//so both are trivially destructible and freed together with the database
 struct Stop {
-    explicit Stop(std::string stop_name, geo::Coord coords);
-    std::string name;
+    std::string_view name;
     geo::Coord location;
+    //dense, in order of addition: [0, stop count)
+    uint32_t id = 0;
 };
 
 using StopPtr = const Stop*;
 
 struct Bus {
-    //move string during construction
-    explicit Bus(std::string name, std::vector<StopPtr> stops, bool is_roundtrip, StopPtr final_stop = nullptr);
-    std::string name;
-    std::vector<StopPtr> stops;
+    std::string_view name;
+    std::span<const StopPtr> stops;
     bool is_roundtrip = false;
     StopPtr final_stop = nullptr;
+    //dense, in order of addition: [0, bus count)
+    uint32_t id = 0;
 };
 
 using BusPtr = const Bus*;
@@ -133,6 +140,28 @@ struct RouteStat {
     std::vector<RouteItem> items;
 };
 
+//Travel times between every source & target: times[i * target_count + j] from source i to target j,
+//none if there is no route or the stop is unknown to the router
+struct MatrixStat {
+    int request_id = 0;
+    bool exists = false;
+    size_t source_count = 0;
+    size_t target_count = 0;
+    std::vector<std::optional<double>> times;
+};
+
+struct ReachableStop {
+    std::string_view name;
+    double time = 0.0;
+};
+
+//Stops reachable from a stop within max_time, ordered by travel time (then name), the origin included
+struct ReachableStat {
+    int request_id = 0;
+    bool exists = false;
+    std::vector<ReachableStop> stops;
+};
+
 ///Another option:
 
 /*
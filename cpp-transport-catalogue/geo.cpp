@@ -5,12 +5,31 @@
 
 namespace geo {
 
+static const double EARTH_RADIUS = 6371000;
+static const double DEGREES_TO_RADIANS = M_PI / 180.0;
+
 double ComputeDistance(Coord from, Coord to) {
     using namespace std;
-    const double dr = M_PI / 180.0;
+    const double dr = DEGREES_TO_RADIANS;
     return acos(sin(from.lat * dr) * sin(to.lat * dr)
                 + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
-        * 6371000;
+        * EARTH_RADIUS;
+}
+
+EarthPoint ToEarthPoint(Coord coord) {
+    using namespace std;
+    const double lat = coord.lat * DEGREES_TO_RADIANS;
+    const double lng = coord.lng * DEGREES_TO_RADIANS;
+    return {EARTH_RADIUS * cos(lat) * cos(lng),
+            EARTH_RADIUS * cos(lat) * sin(lng),
+            EARTH_RADIUS * sin(lat)};
+}
+
+double ComputeChordDistance(EarthPoint from, EarthPoint to) {
+    const double dx = from.x - to.x;
+    const double dy = from.y - to.y;
+    const double dz = from.z - to.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
 }
 
 }  // namespace geo
@@ -15,4 +15,15 @@ struct Coord {
 };
 
 double ComputeDistance(Coord from, Coord to);
+
+//Cartesian coordinates of a point on the Earth surface, meters from the Earth center
+struct EarthPoint {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+};
+
+EarthPoint ToEarthPoint(Coord coord);
+//Straight line through the Earth: never longer than ComputeDistance, no trigonometry
+double ComputeChordDistance(EarthPoint from, EarthPoint to);
 }
@@ -3,6 +3,8 @@
 #include "ranges.h"
 
 #include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 #include <limits>
 
@@ -11,6 +13,24 @@ namespace graph {
 using VertexId = size_t;
 using EdgeId = size_t;
 
+//Route weight arithmetic of the routers: UNREACHABLE is +infinity for floating point weights
+//and max() for integer ones (e.g. fixed-point minutes), where sums saturate at it instead of wrapping
+template <typename Weight>
+struct WeightTraits {
+    static constexpr Weight UNREACHABLE = std::numeric_limits<Weight>::has_infinity
+                                        ? std::numeric_limits<Weight>::infinity()
+                                        : std::numeric_limits<Weight>::max();
+
+    //non-negative weights only
+    static constexpr Weight Add(Weight lhs, Weight rhs) {
+        if constexpr (std::is_integral_v<Weight>) {
+            return lhs > UNREACHABLE - rhs ? UNREACHABLE : lhs + rhs;
+        } else {
+            return lhs + rhs;
+        }
+    }
+};
+
 template <typename Weight>
 struct Edge {
     VertexId from;
@@ -29,14 +49,44 @@ public:
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
     
+    //Packs edges into compressed sparse rows, sorted by source vertex (in order of addition
+    //for each vertex) and drops the per-vertex incidence lists; no edges can be added afterwards
+    void Freeze();
+    bool IsFrozen() const;
+    
+    //Replaces the weights of all edges, weights[edge_id], topology stays the same
+    void SetWeights(const std::vector<Weight>& weights);
+    
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+    
+    //Frozen graph only: outgoing edges of vertex are [GetOutBegin(vertex), GetOutBegin(vertex + 1))
+    //positions of the parallel arrays below, unchecked
+    size_t GetOutBegin(VertexId vertex) const {
+        return out_offsets_[vertex];
+    }
+    const EdgeId* GetOutEdgeIds() const {
+        return out_edge_ids_.data();
+    }
+    const VertexId* GetOutTargets() const {
+        return out_targets_.data();
+    }
+    const Weight* GetOutWeights() const {
+        return out_weights_.data();
+    }
 
 private:
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+    
+    //compressed sparse rows, filled by Freeze()
+    bool is_frozen_ = false;
+    std::vector<size_t> out_offsets_;
+    std::vector<EdgeId> out_edge_ids_;
+    std::vector<VertexId> out_targets_;
+    std::vector<Weight> out_weights_;
 };
 
 template <typename Weight>
@@ -46,6 +96,9 @@ DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+        if(is_frozen_) {
+            throw std::logic_error("graph::AddEdge -> graph is frozen");
+        }
         edges_.push_back(edge);
         const EdgeId id = edges_.size() - 1;
     
@@ -58,9 +111,53 @@ EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
         return id;
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if(is_frozen_) {
+        return;
+    }
+    const size_t vertex_count = incidence_lists_.size();
+    out_offsets_.assign(vertex_count + 1, 0);
+    out_edge_ids_.reserve(edges_.size());
+    out_targets_.reserve(edges_.size());
+    out_weights_.reserve(edges_.size());
+    
+    for(VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        out_offsets_[vertex] = out_edge_ids_.size();
+        for(const EdgeId edge_id : incidence_lists_[vertex]) {
+            out_edge_ids_.push_back(edge_id);
+            out_targets_.push_back(edges_[edge_id].to);
+            out_weights_.push_back(edges_[edge_id].weight);
+        }
+    }
+    out_offsets_[vertex_count] = out_edge_ids_.size();
+    
+    //incident edges are served from out_edge_ids_ from now on
+    std::vector<IncidenceList>().swap(incidence_lists_);
+    is_frozen_ = true;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetWeights(const std::vector<Weight>& weights) {
+    if(weights.size() != edges_.size()) {
+        throw std::invalid_argument("graph::SetWeights -> one weight per edge expected");
+    }
+    for(EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        edges_[edge_id].weight = weights[edge_id];
+    }
+    for(size_t pos = 0; pos < out_edge_ids_.size(); ++pos) {
+        out_weights_[pos] = weights[out_edge_ids_[pos]];
+    }
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return is_frozen_;
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return is_frozen_ ? out_offsets_.size() - 1 : incidence_lists_.size();
 }
 
 template <typename Weight>
@@ -76,6 +173,12 @@ const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
+    if(is_frozen_) {
+        if(vertex >= GetVertexCount()) {
+            throw std::out_of_range("graph::GetIncidentEdges -> vertex id is out of range");
+        }
+        return {out_edge_ids_.begin() + out_offsets_[vertex], out_edge_ids_.begin() + out_offsets_[vertex + 1]};
+    }
     return _ranges::AsRange(incidence_lists_.at(vertex));
 }
 }  // namespace graph
@@ -2,6 +2,7 @@
 
 #include <sstream>
 #include <fstream>
+#include <unordered_map>
 
 using namespace std::literals;
 
@@ -23,7 +24,7 @@ void JsonReader::ParseAndAddStops(const json::Array& database_commands, Transpor
             
             const geo::Coord stop_coords{map.at("latitude"s).AsDouble(), map.at("longitude"s).AsDouble()};
             
-            db.AddStop(std::string(stop_name), stop_coords);
+            db.AddStop(stop_name, stop_coords);
             
             //build road distances map:
             auto& distances = stops_road_distances[stop_name];
@@ -98,16 +99,56 @@ RendererSettings JsonReader::ParseRendererSettings(const json::Map& rsets) const
 }
 
 BusRouterSettings JsonReader::ParseRouterSettings(const json::Map& rsets) const {
-    int wait_time = 0;
-    double velocity_kmh = 0;
+    BusRouterSettings settings = {};
     try {
-        wait_time = rsets.at("bus_wait_time"s).AsInt();
-        velocity_kmh = rsets.at("bus_velocity"s).AsDouble();
+        settings.wait_time = rsets.at("bus_wait_time"s).AsInt();
+        settings.velocity_kmh = rsets.at("bus_velocity"s).AsDouble();
     } catch(std::exception& ex) {
         //TODO: temp debug
         CERR_ERROR << "Missing Router settings error:" << ex.what() << std::endl;
     }
-    return {wait_time, velocity_kmh};
+    //optional, all_pairs by default
+    if(rsets.count("router_type"s) > 0) {
+        const auto& type = rsets.at("router_type"s).AsString();
+        if(type == "dijkstra"s) {
+            settings.router_type = RouterType::dijkstra;
+        } else if(type == "contraction_hierarchy"s) {
+            settings.router_type = RouterType::contraction_hierarchy;
+        } else if(type == "astar"s) {
+            settings.router_type = RouterType::astar;
+        } else if(type == "alt"s) {
+            settings.router_type = RouterType::alt;
+        } else if(type == "raptor"s) {
+            settings.router_type = RouterType::raptor;
+        } else if(type != "all_pairs"s) {
+            CERR_ERROR << "Unknown router_type: " << type << ", using all_pairs" << std::endl;
+        }
+    }
+    if(rsets.count("graph_model"s) > 0) {
+        const auto& model = rsets.at("graph_model"s).AsString();
+        if(model == "linear"s) {
+            settings.graph_model = GraphModel::linear;
+        } else if(model != "stop_pairs"s) {
+            CERR_ERROR << "Unknown graph_model: " << model << ", using stop_pairs" << std::endl;
+        }
+    }
+    if(rsets.count("router_threads"s) > 0) {
+        settings.router_threads = static_cast<size_t>(std::max(0, rsets.at("router_threads"s).AsInt()));
+    }
+    //optional, json ints are 32-bit -> read as double
+    if(rsets.count("tree_cache_bytes"s) > 0) {
+        settings.tree_cache_bytes = static_cast<size_t>(rsets.at("tree_cache_bytes"s).AsDouble());
+    }
+    if(rsets.count("landmark_count"s) > 0) {
+        settings.landmark_count = static_cast<size_t>(std::max(0, rsets.at("landmark_count"s).AsInt()));
+    }
+    if(rsets.count("route_cache_bytes"s) > 0) {
+        settings.route_cache_bytes = static_cast<size_t>(rsets.at("route_cache_bytes"s).AsDouble());
+    }
+    if(rsets.count("route_cache_entries"s) > 0) {
+        settings.route_cache_entries = static_cast<size_t>(rsets.at("route_cache_entries"s).AsDouble());
+    }
+    return settings;
 }
 
 void JsonReader::ParseStatRequests(const json::Array& stat_reqs, std::queue<StatRequest>& request_queue) {
@@ -128,9 +169,19 @@ void JsonReader::ParseStatRequests(const json::Array& stat_reqs, std::queue<Stat
         if(request.type == "Route"s) {
             request.from = request_map.at("from"s).AsString();
             request.to = request_map.at("to"s).AsString();
+        } else if(request.type == "Matrix"s) {
+            for(const auto& stop : request_map.at("sources"s).AsArray()) {
+                request.sources.push_back(stop.AsString());
+            }
+            for(const auto& stop : request_map.at("targets"s).AsArray()) {
+                request.targets.push_back(stop.AsString());
+            }
         } else if(request.type != "Map"){
             request.name = request_map.at("name"s).AsString();
         }
+        if(request.type == "Reachable"s) {
+            request.max_time = request_map.at("max_time"s).AsDouble();
+        }
         request_queue.push(request);
     }
 }
@@ -156,6 +207,19 @@ void JsonReader::ParseInput(std::istream& in) {
             const auto& rsets = parsed_json_.at("routing_settings"s).AsMap();
             req_handler_.UpdRouterSettings(ParseRouterSettings(rsets));
         }
+        //4.Stat requests processing threads, optional
+        if(parsed_json_.count("processing_settings"s) > 0) {
+            const auto& psets = parsed_json_.at("processing_settings"s).AsMap();
+            if(psets.count("threads"s) > 0) {
+                request_threads_ = static_cast<size_t>(std::max(0, psets.at("threads"s).AsInt()));
+            }
+        }
+        //Database is read-only from here: road distances & bus stats
+        database_.Finalize(request_threads_);
+        //4.Router file for make_base / process_requests modes
+        if(parsed_json_.count("serialization_settings"s) > 0) {
+            router_file_ = parsed_json_.at("serialization_settings"s).AsMap().at("file"s).AsString();
+        }
         //5.If required, process stat requests
         if(parsed_json_.count("stat_requests") > 0) {
             const auto& stat_reqs = parsed_json_.at("stat_requests"s).AsArray();
@@ -181,7 +245,7 @@ json::Map JsonReader::MakeStatJson(const StopStat& stat) const {
     buses.StartMap().Key("buses"s).StartArray();
     
     for(auto bus_ptr : stat.BusesForStop) {
-        buses.Value(bus_ptr->name);
+        buses.Value(std::string(bus_ptr->name));
     }
     buses.EndArray().Key("request_id"s).Value(stat.request_id).EndMap();
     
@@ -212,13 +276,50 @@ json::Map JsonReader::MakeStatJson(const RouteStat& stat) const {
     return route_info.Build().AsMap();
 }
 
-void JsonReader::StoreSvgMap(std::string map, int request_id) {
+//times[i][j] from sources[i] to targets[j], null if there is no route
+json::Map JsonReader::MakeStatJson(const MatrixStat& stat) const {
+    json::Array rows;
+    rows.reserve(stat.source_count);
+    for(size_t i = 0; i < stat.source_count; ++i) {
+        json::Array row;
+        row.reserve(stat.target_count);
+        for(size_t j = 0; j < stat.target_count; ++j) {
+            const auto& time = stat.times[i * stat.target_count + j];
+            if(time) {
+                row.emplace_back(*time);
+            } else {
+                row.emplace_back(nullptr);
+            }
+        }
+        rows.emplace_back(std::move(row));
+    }
+    return json::Builder{}.StartMap()
+           .Key("request_id"s).Value(stat.request_id)
+           .Key("times"s).Value(std::move(rows))
+           .EndMap().Build().AsMap();
+}
+
+json::Map JsonReader::MakeStatJson(const ReachableStat& stat) const {
+    json::Builder reachable;
+    reachable.StartMap()
+        .Key("request_id"s).Value(stat.request_id)
+        .Key("stops"s).StartArray();
+    for(const auto& stop : stat.stops) {
+        reachable.StartMap()
+            .Key("stop_name"s).Value(std::string(stop.name))
+            .Key("time"s).Value(stop.time)
+            .EndMap();
+    }
+    reachable.EndArray().EndMap();
+    return reachable.Build().AsMap();
+}
+
+json::Node JsonReader::MakeSvgMapAnswer(std::string map, int request_id) const {
     const json::Map answer = {
         {"map"s, {std::string(std::move(map))}},
         {"request_id"s, {request_id}}
     };
-    json::Node node{answer};
-    stat_request_answers_.push_back(node);
+    return json::Node{answer};
 }
 
 svg::Point JsonReader::ParsePoint(const json::Node& point_node) const {
@@ -267,30 +368,100 @@ std::vector<svg::Color> JsonReader::ParsePalette(const json::Node& pallete_node)
 }
 
 void JsonReader::ProcessStatRequests() {
+    std::vector<StatRequest> requests;
+    requests.reserve(request_queue_.size());
     while(!request_queue_.empty()) {
-        StatRequest request = std::move(request_queue_.front());
+        requests.push_back(std::move(request_queue_.front()));
         request_queue_.pop();
-        
-        CERR << "Processing request: " << request.type << " for: " << request.name << std::endl;
-        try {
-            if(request.type == "Bus"sv) {
-                StoreRequestAnswer(req_handler_.GetBusStat(request.id, request.name));
-            }
-            else if(request.type == "Stop"sv) {
-                StoreRequestAnswer(req_handler_.GetStopStat(request.id, request.name));
-            }
-            else if(request.type == "Map"sv) {
-                std::stringstream ss;
-                req_handler_.RenderMap(ss);
-                StoreSvgMap(ss.str(), request.id);
+    }
+    //answers in request order, failed requests get none
+    std::vector<std::optional<json::Node>> answers(requests.size());
+    
+    //each task writes only the answers of its own requests
+    const auto request_groups = GroupStatRequests(requests);
+    ThreadPool pool(request_threads_);
+    pool.ParallelFor(request_groups.size(), [&](size_t group) {
+        ProcessRequestGroup(requests, request_groups[group], answers);
+    });
+    
+    for(auto& answer : answers) {
+        if(answer) {
+            stat_request_answers_.push_back(std::move(*answer));
+        }
+    }
+}
+
+std::vector<std::vector<size_t>> JsonReader::GroupStatRequests(const std::vector<StatRequest>& requests) const {
+    std::vector<std::vector<size_t>> groups;
+    //Route requests with the same origin share a group, placed where the first of them is
+    std::unordered_map<std::string_view, size_t> route_group_by_origin;
+    for(size_t i = 0; i < requests.size(); ++i) {
+        if(requests[i].type != "Route"sv) {
+            groups.push_back({i});
+            continue;
+        }
+        const auto [it, inserted] = route_group_by_origin.insert({requests[i].from, groups.size()});
+        if(inserted) {
+            groups.emplace_back();
+        }
+        groups[it->second].push_back(i);
+    }
+    return groups;
+}
+
+void JsonReader::ProcessRequestGroup(const std::vector<StatRequest>& requests, const std::vector<size_t>& group,
+                                     std::vector<std::optional<json::Node>>& answers) const {
+    const StatRequest& request = requests[group.front()];
+    try {
+        if(request.type == "Route"sv) {
+            std::vector<int> request_ids;
+            std::vector<std::string_view> to_stops;
+            for(const size_t i : group) {
+                request_ids.push_back(requests[i].id);
+                to_stops.push_back(requests[i].to);
             }
-            else if(request.type == "Route"sv) {
-                StoreRequestAnswer(req_handler_.GetRoute(request.id, request.from, request.to));
+            CERR << "Processing " << group.size() << " Route requests from: " << request.from << std::endl;
+            const auto stats = req_handler_.GetRoutes(request_ids, request.from, to_stops);
+            for(size_t i = 0; i < group.size(); ++i) {
+                answers[group[i]] = MakeRequestAnswer(stats[i]);
             }
-        } catch(std::exception& ex) {
-            std::cerr << "ERROR: ProcessStatRequests: " << ex.what() << std::endl;
+            return;
+        }
+        CERR << "Processing request: " << request.type << " for: " << request.name << std::endl;
+        if(request.type == "Bus"sv) {
+            answers[group.front()] = MakeRequestAnswer(req_handler_.GetBusStat(request.id, request.name));
+        }
+        else if(request.type == "Stop"sv) {
+            answers[group.front()] = MakeRequestAnswer(req_handler_.GetStopStat(request.id, request.name));
+        }
+        else if(request.type == "Matrix"sv) {
+            answers[group.front()] = MakeRequestAnswer(req_handler_.GetMatrix(request.id, request.sources, request.targets));
+        }
+        else if(request.type == "Reachable"sv) {
+            answers[group.front()] = MakeRequestAnswer(req_handler_.GetReachable(request.id, request.name, request.max_time));
+        }
+        else if(request.type == "Map"sv) {
+            std::stringstream ss;
+            req_handler_.RenderMap(ss);
+            answers[group.front()] = MakeSvgMapAnswer(ss.str(), request.id);
         }
+    } catch(std::exception& ex) {
+        std::cerr << "ERROR: ProcessStatRequests: " << ex.what() << std::endl;
+    }
+}
+
+void JsonReader::SaveRouter() const {
+    if(router_file_.empty()) {
+        throw std::runtime_error("No serialization_settings file in json");
+    }
+    req_handler_.SaveRouter(router_file_);
+}
+
+void JsonReader::LoadRouter() const {
+    if(router_file_.empty()) {
+        throw std::runtime_error("No serialization_settings file in json");
     }
+    req_handler_.LoadRouter(router_file_);
 }
 
 void JsonReader::PrintRequestAnswers(std::ostream& out) const {
@@ -5,10 +5,14 @@
 #include "json_builder.h"
 #include "map_renderer.h"
 #include "request_handler.h"
+#include "thread_pool.h"
 #include "transport_catalogue.h"
 
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 using namespace std::literals;
 
@@ -21,6 +25,10 @@ public:
     void ProcessStatRequests();
     void PrintRequestAnswers(std::ostream& out) const;
     
+    //use file from serialization_settings
+    void SaveRouter() const;
+    void LoadRouter() const;
+    
 private:
     struct StatRequest {
         int id = 0;
@@ -28,6 +36,11 @@ private:
         std::string_view name = {};
         std::string_view from = {};
         std::string_view to   = {};
+        //Matrix request stops
+        std::vector<std::string_view> sources = {};
+        std::vector<std::string_view> targets = {};
+        //Reachable request budget, minutes
+        double max_time = 0.0;
     };
     
     TransportDb& database_;
@@ -35,14 +48,24 @@ private:
     std::queue<StatRequest> request_queue_;
     json::Map parsed_json_;
     json::Array stat_request_answers_;
+    std::filesystem::path router_file_;
+    //processing_settings.threads: 1 = serial, 0 = all cores
+    size_t request_threads_ = 1;
 
     json::Map MakeStatJson(const BusStat& stat) const;
     json::Map MakeStatJson(const StopStat& stat) const;
     json::Map MakeStatJson(const RouteStat& stat) const;
+    json::Map MakeStatJson(const MatrixStat& stat) const;
+    json::Map MakeStatJson(const ReachableStat& stat) const;
     
     template <typename Stat>
-    void StoreRequestAnswer(const Stat& stat);
-    void StoreSvgMap(std::string map, int request_id);
+    json::Node MakeRequestAnswer(const Stat& stat) const;
+    json::Node MakeSvgMapAnswer(std::string map, int request_id) const;
+    //Groups of request indices, processed independently: one request,
+    //or all Route requests from one origin (answered in a batch)
+    std::vector<std::vector<size_t>> GroupStatRequests(const std::vector<StatRequest>& requests) const;
+    void ProcessRequestGroup(const std::vector<StatRequest>& requests, const std::vector<size_t>& group,
+                             std::vector<std::optional<json::Node>>& answers) const;
     
     void ParseAndAddStops(const json::Array& database_commands, TransportDb& db) const;
     void ParseAndAddBuses(const json::Array& database_commands, TransportDb& db) const;
@@ -59,7 +82,7 @@ private:
 using namespace std::literals;
 
 template <typename Stat>
-void JsonReader::StoreRequestAnswer(const Stat& stat) {
+json::Node JsonReader::MakeRequestAnswer(const Stat& stat) const {
     //make the Json document, format:
     json::Node answer;
     if(stat.exists) {
@@ -70,5 +93,5 @@ void JsonReader::StoreRequestAnswer(const Stat& stat) {
             .Key("error_message"s).Value("not found"s)
             .EndMap().Build();
     }
-    stat_request_answers_.emplace_back(answer);
+    return answer;
 }
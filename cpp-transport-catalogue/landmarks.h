@@ -0,0 +1,124 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+//ALT preprocessing: route weights from & to a few landmark vertices give, by the triangle inequality,
+//a lower bound of the route weight between any two vertices:
+//  weight(v, t) >= weight(v, L) - weight(t, L)  and  weight(v, t) >= weight(L, t) - weight(L, v).
+//The bound is a consistent potential for AStarRouter. Landmarks are picked by farthest selection:
+//each next one is the vertex farthest from all landmarks picked so far (unreachable ones first).
+//Two weights per landmark & vertex, stored by vertex -> one cache line per potential evaluation.
+//Graph must be frozen
+template <typename Weight>
+class Landmarks {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    static constexpr Weight UNREACHABLE = DijkstraRouter<Weight>::UNREACHABLE;
+
+    Landmarks(const Graph& graph, size_t landmark_count);
+
+    //Lower bound of the route weight from vertex to target
+    Weight GetLowerBound(VertexId vertex, VertexId target) const;
+
+    //Potential for AStarRouter::BuildRoute towards target
+    auto GetPotential(VertexId target) const {
+        return [this, target](VertexId vertex) {
+            return GetLowerBound(vertex, target);
+        };
+    }
+
+    const std::vector<VertexId>& GetLandmarks() const {
+        return landmarks_;
+    }
+
+private:
+    //weights from & to landmark i of vertex v: [v * landmark_count + i]
+    std::vector<Weight> from_landmarks_;
+    std::vector<Weight> to_landmarks_;
+    std::vector<VertexId> landmarks_;
+
+    static constexpr Weight ZERO_WEIGHT{};
+};
+
+template <typename Weight>
+Landmarks<Weight>::Landmarks(const Graph& graph, size_t landmark_count) {
+    if (!graph.IsFrozen()) {
+        throw std::logic_error("Landmarks: graph should be frozen");
+    }
+    const size_t vertex_count = graph.GetVertexCount();
+    landmark_count = std::min(landmark_count, vertex_count);
+
+    //weights to a landmark are weights from it in the reversed graph
+    Graph reversed(vertex_count);
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const Edge<Weight>& edge = graph.GetEdge(edge_id);
+        reversed.AddEdge({edge.to, edge.from, edge.weight});
+    }
+    reversed.Freeze();
+    const DijkstraRouter<Weight> forward_router(graph);
+    const DijkstraRouter<Weight> backward_router(reversed);
+
+    std::vector<std::vector<Weight>> from_weights;
+    std::vector<std::vector<Weight>> to_weights;
+    //smallest weight between a vertex & any landmark picked so far, either direction
+    std::vector<Weight> nearest(vertex_count, UNREACHABLE);
+    std::vector<bool> is_landmark(vertex_count, false);
+    VertexId next = 0;
+    for (size_t i = 0; i < landmark_count; ++i) {
+        landmarks_.push_back(next);
+        is_landmark[next] = true;
+        from_weights.push_back(forward_router.BuildTree(next).weights);
+        to_weights.push_back(backward_router.BuildTree(next).weights);
+
+        bool found = false;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            nearest[vertex] = std::min({nearest[vertex], from_weights.back()[vertex], to_weights.back()[vertex]});
+            if (!is_landmark[vertex] && (!found || nearest[vertex] > nearest[next])) {
+                next = vertex;
+                found = true;
+            }
+        }
+    }
+
+    from_landmarks_.resize(vertex_count * landmarks_.size());
+    to_landmarks_.resize(vertex_count * landmarks_.size());
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (size_t i = 0; i < landmarks_.size(); ++i) {
+            from_landmarks_[vertex * landmarks_.size() + i] = from_weights[i][vertex];
+            to_landmarks_[vertex * landmarks_.size() + i] = to_weights[i][vertex];
+        }
+    }
+}
+
+template <typename Weight>
+Weight Landmarks<Weight>::GetLowerBound(VertexId vertex, VertexId target) const {
+    const size_t count = landmarks_.size();
+    const Weight* vertex_from = from_landmarks_.data() + vertex * count;
+    const Weight* vertex_to = to_landmarks_.data() + vertex * count;
+    const Weight* target_from = from_landmarks_.data() + target * count;
+    const Weight* target_to = to_landmarks_.data() + target * count;
+
+    Weight bound = ZERO_WEIGHT;
+    for (size_t i = 0; i < count; ++i) {
+        //a term with an unreachable weight bounds nothing, negative terms are skipped (unsigned weights)
+        if (vertex_to[i] != UNREACHABLE && target_to[i] < vertex_to[i]) {
+            bound = std::max(bound, vertex_to[i] - target_to[i]);
+        }
+        if (target_from[i] != UNREACHABLE && vertex_from[i] < target_from[i]) {
+            bound = std::max(bound, target_from[i] - vertex_from[i]);
+        }
+    }
+    return bound;
+}
+
+}  // namespace graph
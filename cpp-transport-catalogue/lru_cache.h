@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t entries = 0;
+    size_t bytes_used = 0;
+    size_t max_bytes = 0;
+    size_t max_entries = 0;
+
+    double GetHitRate() const {
+        return hits + misses == 0 ? 0.0 : 1.0 * hits / (hits + misses);
+    }
+};
+
+inline constexpr size_t NO_ENTRY_LIMIT = std::numeric_limits<size_t>::max();
+
+//Least-recently-used cache bounded by the total size of stored values (in bytes) & their count,
+//values are shared, so an entry evicted while in use stays valid for its holder.
+//All methods lock the cache -> safe to use from several threads
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class LruCache {
+public:
+    using ValuePtr = std::shared_ptr<const Value>;
+
+    explicit LruCache(size_t max_bytes = 0, size_t max_entries = NO_ENTRY_LIMIT)
+    : max_bytes_(max_bytes)
+    , max_entries_(max_entries) {
+    }
+
+    //nullptr if not found, counts as a miss
+    ValuePtr Find(const Key& key) {
+        std::lock_guard lock(mutex_);
+        auto it = index_.find(key);
+        if(it == index_.end()) {
+            ++misses_;
+            return nullptr;
+        }
+        ++hits_;
+        //move to the front -> most recently used
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->value;
+    }
+
+    //values larger than the whole budget are not stored
+    void Insert(const Key& key, ValuePtr value, size_t bytes) {
+        std::lock_guard lock(mutex_);
+        if(bytes > max_bytes_ || max_entries_ == 0) {
+            return;
+        }
+        Erase(key);
+        entries_.push_front({key, std::move(value), bytes});
+        index_[key] = entries_.begin();
+        bytes_used_ += bytes;
+        EvictToFit();
+    }
+
+    void SetMaxBytes(size_t max_bytes) {
+        std::lock_guard lock(mutex_);
+        max_bytes_ = max_bytes;
+        EvictToFit();
+    }
+
+    void SetLimits(size_t max_bytes, size_t max_entries) {
+        std::lock_guard lock(mutex_);
+        max_bytes_ = max_bytes;
+        max_entries_ = max_entries;
+        EvictToFit();
+    }
+
+    void Clear() {
+        std::lock_guard lock(mutex_);
+        entries_.clear();
+        index_.clear();
+        bytes_used_ = 0;
+    }
+
+    CacheStats GetStats() const {
+        std::lock_guard lock(mutex_);
+        return {hits_, misses_, entries_.size(), bytes_used_, max_bytes_, max_entries_};
+    }
+
+private:
+    struct Entry {
+        Key key;
+        ValuePtr value;
+        size_t bytes = 0;
+    };
+    using EntryList = std::list<Entry>;
+
+    void Erase(const Key& key) {
+        auto it = index_.find(key);
+        if(it == index_.end()) {
+            return;
+        }
+        bytes_used_ -= it->second->bytes;
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+
+    void EvictToFit() {
+        while((bytes_used_ > max_bytes_ || entries_.size() > max_entries_) && !entries_.empty()) {
+            const Entry& lru = entries_.back();
+            bytes_used_ -= lru.bytes;
+            index_.erase(lru.key);
+            entries_.pop_back();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    size_t max_bytes_ = 0;
+    size_t max_entries_ = NO_ENTRY_LIMIT;
+    size_t bytes_used_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+
+    EntryList entries_;
+    std::unordered_map<Key, typename EntryList::iterator, Hasher> index_;
+};
+
+//LruCache split into independently locked shards by key hash:
+//concurrent lookups of different keys rarely wait for each other.
+//Limits are divided evenly, so the least recently used entry is evicted per shard, not globally
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class ShardedLruCache {
+public:
+    using Shard = LruCache<Key, Value, Hasher>;
+    using ValuePtr = typename Shard::ValuePtr;
+
+    static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+
+    explicit ShardedLruCache(size_t max_bytes = 0, size_t max_entries = NO_ENTRY_LIMIT,
+                             size_t shard_count = DEFAULT_SHARD_COUNT)
+    : shards_(std::max<size_t>(shard_count, 1)) {
+        SetLimits(max_bytes, max_entries);
+    }
+
+    ValuePtr Find(const Key& key) {
+        return GetShard(key).Find(key);
+    }
+
+    void Insert(const Key& key, ValuePtr value, size_t bytes) {
+        GetShard(key).Insert(key, std::move(value), bytes);
+    }
+
+    void SetLimits(size_t max_bytes, size_t max_entries) {
+        const size_t count = shards_.size();
+        for(auto& shard : shards_) {
+            shard.SetLimits(max_bytes / count,
+                            max_entries == NO_ENTRY_LIMIT ? NO_ENTRY_LIMIT : (max_entries + count - 1) / count);
+        }
+    }
+
+    void Clear() {
+        for(auto& shard : shards_) {
+            shard.Clear();
+        }
+    }
+
+    //sum over shards, each one is a consistent snapshot
+    CacheStats GetStats() const {
+        CacheStats stats;
+        for(const auto& shard : shards_) {
+            const CacheStats shard_stats = shard.GetStats();
+            stats.hits += shard_stats.hits;
+            stats.misses += shard_stats.misses;
+            stats.entries += shard_stats.entries;
+            stats.bytes_used += shard_stats.bytes_used;
+            stats.max_bytes += shard_stats.max_bytes;
+            stats.max_entries = shard_stats.max_entries == NO_ENTRY_LIMIT
+                                ? NO_ENTRY_LIMIT : stats.max_entries + shard_stats.max_entries;
+        }
+        return stats;
+    }
+
+private:
+    Shard& GetShard(const Key& key) {
+        //high bits of a multiplicative mix: shard choice independent of the bucket choice inside a shard
+        const uint64_t mixed = static_cast<uint64_t>(Hasher{}(key)) * 0x9E3779B97F4A7C15ull;
+        return shards_[(mixed >> 32) % shards_.size()];
+    }
+
+    std::vector<Shard> shards_;
+};
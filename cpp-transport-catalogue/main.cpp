@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <stdexcept>
 #include <string>
 
 #include "json_reader.h"
@@ -9,7 +10,19 @@
 using namespace std;
 namespace fs = std::filesystem;
 
-int main() {
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+}
+
+//no mode: build everything & answer stat_requests
+//make_base: build the router & save it to serialization_settings.file
+//process_requests: map the saved router from serialization_settings.file & answer stat_requests
+int main(int argc, char* argv[]) {
+    const std::string_view mode = argc > 1 ? std::string_view(argv[1]) : ""sv;
+    if(!mode.empty() && mode != "make_base"sv && mode != "process_requests"sv) {
+        PrintUsage();
+        return 1;
+    }
     
     TransportDb database;
     MapRenderer map_renderer;
@@ -27,6 +40,19 @@ int main() {
 //    std::ofstream out (in_file.replace_filename(out_filename), std::ios_base::out);
     
     jreader.ParseInput(in);
+    //missing, unwritable, corrupted or other version router file
+    try {
+        if(mode == "make_base"sv) {
+            jreader.SaveRouter();
+            return 0;
+        }
+        if(mode == "process_requests"sv) {
+            jreader.LoadRouter();
+        }
+    } catch(const std::exception& ex) {
+        std::cerr << "Router file error: " << ex.what() << '\n';
+        return 1;
+    }
     jreader.ProcessStatRequests();
     jreader.PrintRequestAnswers(out);
     
@@ -0,0 +1,38 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std::literals;
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error("MappedFile: cannot open "s + path.string());
+    }
+    struct stat file_stat = {};
+    if(fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("MappedFile: cannot read size of "s + path.string());
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    //the mapping stays valid after the descriptor is closed
+    close(fd);
+    
+    if(data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::runtime_error("MappedFile: cannot map "s + path.string());
+    }
+}
+
+MappedFile::~MappedFile() {
+    if(data_) {
+        munmap(data_, size_);
+    }
+}
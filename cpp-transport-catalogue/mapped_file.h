@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+//Read-only memory mapping of a whole file (POSIX mmap),
+//pages are shared between all processes mapping the same file
+class MappedFile {
+public:
+    //throws std::runtime_error if the file cannot be opened or mapped
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    const char* GetData() const {
+        return static_cast<const char*>(data_);
+    }
+    size_t GetSize() const {
+        return size_;
+    }
+    
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
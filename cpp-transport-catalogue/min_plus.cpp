@@ -0,0 +1,228 @@
+#include "min_plus.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MIN_PLUS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+namespace {
+
+using Kernel = void (*)(double, uint32_t, uint32_t, double*, uint32_t*, const double*, const uint32_t*, size_t);
+using IntKernel = void (*)(uint32_t, uint32_t, uint32_t, uint32_t*, uint32_t*,
+                           const uint32_t*, const uint32_t*, size_t);
+
+//also the tail of the vector kernels
+void RelaxScalar(double weight_from, uint32_t prev_edge_from, uint32_t no_edge,
+                 double* row_weights, uint32_t* row_prev_edges,
+                 const double* through_weights, const uint32_t* through_prev_edges, size_t count) {
+    for(size_t i = 0; i < count; ++i) {
+        const double candidate_weight = weight_from + through_weights[i];
+        if(candidate_weight < row_weights[i]) {
+            row_weights[i] = candidate_weight;
+            row_prev_edges[i] = through_prev_edges[i] != no_edge ? through_prev_edges[i] : prev_edge_from;
+        }
+    }
+}
+
+void RelaxScalar(uint32_t weight_from, uint32_t prev_edge_from, uint32_t no_edge,
+                 uint32_t* row_weights, uint32_t* row_prev_edges,
+                 const uint32_t* through_weights, const uint32_t* through_prev_edges, size_t count) {
+    for(size_t i = 0; i < count; ++i) {
+        //a wrapped sum is smaller than weight_from -> saturate
+        const uint32_t sum = weight_from + through_weights[i];
+        const uint32_t candidate_weight = sum < weight_from ? UINT32_MAX : sum;
+        if(candidate_weight < row_weights[i]) {
+            row_weights[i] = candidate_weight;
+            row_prev_edges[i] = through_prev_edges[i] != no_edge ? through_prev_edges[i] : prev_edge_from;
+        }
+    }
+}
+
+#ifdef MIN_PLUS_X86
+
+__attribute__((target("avx2")))
+void RelaxAvx2(double weight_from, uint32_t prev_edge_from, uint32_t no_edge,
+               double* row_weights, uint32_t* row_prev_edges,
+               const double* through_weights, const uint32_t* through_prev_edges, size_t count) {
+    const __m256d from = _mm256_set1_pd(weight_from);
+    const __m128i prev_from = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m128i none = _mm_set1_epi32(static_cast<int>(no_edge));
+    //low 32 bits of every 64-bit compare lane -> 4 x 32-bit mask
+    const __m256i pack_mask = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        const __m256d row = _mm256_loadu_pd(row_weights + i);
+        const __m256d candidate = _mm256_add_pd(from, _mm256_loadu_pd(through_weights + i));
+        const __m256d better = _mm256_cmp_pd(candidate, row, _CMP_LT_OQ);
+        if(_mm256_movemask_pd(better) == 0) {
+            continue;
+        }
+        //candidate if smaller, row otherwise (also when equal)
+        _mm256_storeu_pd(row_weights + i, _mm256_blendv_pd(row, candidate, better));
+
+        const __m128i better_32 = _mm256_castsi256_si128(
+            _mm256_permutevar8x32_epi32(_mm256_castpd_si256(better), pack_mask));
+        const __m128i through_prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(through_prev_edges + i));
+        const __m128i new_prev = _mm_blendv_epi8(through_prev, prev_from, _mm_cmpeq_epi32(through_prev, none));
+        const __m128i row_prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_prev_edges + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row_prev_edges + i), _mm_blendv_epi8(row_prev, new_prev, better_32));
+    }
+    RelaxScalar(weight_from, prev_edge_from, no_edge, row_weights + i, row_prev_edges + i,
+                through_weights + i, through_prev_edges + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+void RelaxAvx512(double weight_from, uint32_t prev_edge_from, uint32_t no_edge,
+                 double* row_weights, uint32_t* row_prev_edges,
+                 const double* through_weights, const uint32_t* through_prev_edges, size_t count) {
+    const __m512d from = _mm512_set1_pd(weight_from);
+    const __m512i prev_from = _mm512_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m512i none = _mm512_set1_epi32(static_cast<int>(no_edge));
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m512d row = _mm512_loadu_pd(row_weights + i);
+        const __m512d candidate = _mm512_add_pd(from, _mm512_loadu_pd(through_weights + i));
+        const __mmask8 better = _mm512_cmp_pd_mask(candidate, row, _CMP_LT_OQ);
+        if(better == 0) {
+            continue;
+        }
+        _mm512_mask_storeu_pd(row_weights + i, better, candidate);
+
+        //8 edge ids in the low half of a 512-bit register, the high half is never selected
+        const __m512i through_prev = _mm512_castsi256_si512(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(through_prev_edges + i)));
+        const __mmask16 from_self = _mm512_cmpeq_epi32_mask(through_prev, none) & 0xFF;
+        const __m512i new_prev = _mm512_mask_blend_epi32(from_self, through_prev, prev_from);
+        //the low 8 lanes, improved cells only
+        _mm512_mask_storeu_epi32(row_prev_edges + i, static_cast<__mmask16>(better), new_prev);
+    }
+    RelaxScalar(weight_from, prev_edge_from, no_edge, row_weights + i, row_prev_edges + i,
+                through_weights + i, through_prev_edges + i, count - i);
+}
+
+//Integer kernels: a wrapped sum (sum < weight_from) is never better, no saturation needed.
+//Weights & edge ids have the same width -> one mask serves both
+__attribute__((target("avx2")))
+void RelaxAvx2(uint32_t weight_from, uint32_t prev_edge_from, uint32_t no_edge,
+               uint32_t* row_weights, uint32_t* row_prev_edges,
+               const uint32_t* through_weights, const uint32_t* through_prev_edges, size_t count) {
+    const __m256i from = _mm256_set1_epi32(static_cast<int>(weight_from));
+    const __m256i prev_from = _mm256_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m256i none = _mm256_set1_epi32(static_cast<int>(no_edge));
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row_weights + i));
+        const __m256i sum = _mm256_add_epi32(from, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(through_weights + i)));
+        //no unsigned compare in AVX2: a < b <=> min(a, b) != b, a >= b <=> max(a, b) == a
+        const __m256i not_smaller = _mm256_cmpeq_epi32(_mm256_min_epu32(sum, row), row);
+        const __m256i not_wrapped = _mm256_cmpeq_epi32(_mm256_max_epu32(sum, from), sum);
+        const __m256i better = _mm256_andnot_si256(not_smaller, not_wrapped);
+        if(_mm256_movemask_epi8(better) == 0) {
+            continue;
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row_weights + i), _mm256_blendv_epi8(row, sum, better));
+
+        const __m256i through_prev = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(through_prev_edges + i));
+        const __m256i new_prev = _mm256_blendv_epi8(through_prev, prev_from, _mm256_cmpeq_epi32(through_prev, none));
+        const __m256i row_prev = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row_prev_edges + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row_prev_edges + i), _mm256_blendv_epi8(row_prev, new_prev, better));
+    }
+    RelaxScalar(weight_from, prev_edge_from, no_edge, row_weights + i, row_prev_edges + i,
+                through_weights + i, through_prev_edges + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+void RelaxAvx512(uint32_t weight_from, uint32_t prev_edge_from, uint32_t no_edge,
+                 uint32_t* row_weights, uint32_t* row_prev_edges,
+                 const uint32_t* through_weights, const uint32_t* through_prev_edges, size_t count) {
+    const __m512i from = _mm512_set1_epi32(static_cast<int>(weight_from));
+    const __m512i prev_from = _mm512_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m512i none = _mm512_set1_epi32(static_cast<int>(no_edge));
+
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        const __m512i row = _mm512_loadu_si512(row_weights + i);
+        const __m512i sum = _mm512_add_epi32(from, _mm512_loadu_si512(through_weights + i));
+        const __mmask16 better = _mm512_cmplt_epu32_mask(sum, row) & _mm512_cmpge_epu32_mask(sum, from);
+        if(better == 0) {
+            continue;
+        }
+        _mm512_mask_storeu_epi32(row_weights + i, better, sum);
+
+        const __m512i through_prev = _mm512_loadu_si512(through_prev_edges + i);
+        const __m512i new_prev = _mm512_mask_blend_epi32(_mm512_cmpeq_epi32_mask(through_prev, none), through_prev, prev_from);
+        _mm512_mask_storeu_epi32(row_prev_edges + i, better, new_prev);
+    }
+    RelaxScalar(weight_from, prev_edge_from, no_edge, row_weights + i, row_prev_edges + i,
+                through_weights + i, through_prev_edges + i, count - i);
+}
+
+#endif
+
+struct Dispatch {
+    Kernel kernel = RelaxScalar;
+    IntKernel int_kernel = RelaxScalar;
+    const char* name = "scalar";
+
+    Dispatch() {
+#ifdef MIN_PLUS_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f")) {
+            kernel = RelaxAvx512;
+            int_kernel = RelaxAvx512;
+            name = "avx512";
+        } else if(__builtin_cpu_supports("avx2")) {
+            kernel = RelaxAvx2;
+            int_kernel = RelaxAvx2;
+            name = "avx2";
+        }
+#endif
+    }
+};
+
+//chosen on first use, thread-safe static init
+const Dispatch& GetDispatch() {
+    static const Dispatch dispatch;
+    return dispatch;
+}
+
+}  // namespace
+
+void RelaxRowMinPlus(double weight_from, uint32_t prev_edge_from, uint32_t no_edge,
+                     double* row_weights, uint32_t* row_prev_edges,
+                     const double* through_weights, const uint32_t* through_prev_edges, size_t count) {
+    GetDispatch().kernel(weight_from, prev_edge_from, no_edge, row_weights, row_prev_edges,
+                         through_weights, through_prev_edges, count);
+}
+
+void RelaxRowMinPlus(uint32_t weight_from, uint32_t prev_edge_from, uint32_t no_edge,
+                     uint32_t* row_weights, uint32_t* row_prev_edges,
+                     const uint32_t* through_weights, const uint32_t* through_prev_edges, size_t count) {
+    GetDispatch().int_kernel(weight_from, prev_edge_from, no_edge, row_weights, row_prev_edges,
+                             through_weights, through_prev_edges, count);
+}
+
+const char* GetMinPlusKernelName() {
+    return GetDispatch().name;
+}
+
+std::vector<MinPlusKernel> GetMinPlusKernels() {
+    std::vector<MinPlusKernel> kernels{{"scalar", RelaxScalar, RelaxScalar}};
+#ifdef MIN_PLUS_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        kernels.push_back({"avx2", RelaxAvx2, RelaxAvx2});
+    }
+    if(__builtin_cpu_supports("avx512f")) {
+        kernels.push_back({"avx512", RelaxAvx512, RelaxAvx512});
+    }
+#endif
+    return kernels;
+}
+
+}  // namespace graph
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace graph {
+
+//Min-plus row update of the all-pairs table, for i in [0, count):
+//  if weight_from + through_weights[i] < row_weights[i]:
+//      row_weights[i] = weight_from + through_weights[i]
+//      row_prev_edges[i] = through_prev_edges[i] != no_edge ? through_prev_edges[i] : prev_edge_from
+//Same results as the plain loop (min is taken on strictly smaller weights only, +inf never wins).
+//Vectorized: AVX-512 (8 cells per instruction) or AVX2 (4 cells), picked once by the running CPU,
+//plain loop on other CPUs
+void RelaxRowMinPlus(double weight_from, uint32_t prev_edge_from, uint32_t no_edge,
+                     double* row_weights, uint32_t* row_prev_edges,
+                     const double* through_weights, const uint32_t* through_prev_edges, size_t count);
+//Integer weights: the sum saturates at UINT32_MAX (unreachable), which never wins;
+//16 cells per AVX-512 instruction, 8 per AVX2 one
+void RelaxRowMinPlus(uint32_t weight_from, uint32_t prev_edge_from, uint32_t no_edge,
+                     uint32_t* row_weights, uint32_t* row_prev_edges,
+                     const uint32_t* through_weights, const uint32_t* through_prev_edges, size_t count);
+
+//"avx512", "avx2" or "scalar"
+const char* GetMinPlusKernelName();
+
+//Kernels behind RelaxRowMinPlus, for testing the vectorized ones against the plain loop
+struct MinPlusKernel {
+    const char* name = nullptr;
+    void (*relax)(double, uint32_t, uint32_t, double*, uint32_t*, const double*, const uint32_t*, size_t) = nullptr;
+    void (*relax_int)(uint32_t, uint32_t, uint32_t, uint32_t*, uint32_t*, const uint32_t*, const uint32_t*, size_t) = nullptr;
+};
+//"scalar" first, then every vectorized kernel the running CPU supports
+std::vector<MinPlusKernel> GetMinPlusKernels();
+
+}  // namespace graph
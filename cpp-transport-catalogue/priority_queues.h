@@ -0,0 +1,200 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//Queue policies of the Dijkstra-family searches, all of them:
+//  explicit Queue(size_t vertex_count);
+//  bool Empty() const;
+//  void Push(Weight weight, VertexId vertex);     //new vertex or a smaller weight of a queued one
+//  std::pair<Weight, VertexId> Pop();             //smallest weight first
+//A queue may keep the old entry of a vertex pushed again (a stale one), searches skip settled vertices
+
+//std::priority_queue, stale entries stay queued until popped
+template <typename Weight>
+class BinaryHeap {
+public:
+    using Item = std::pair<Weight, VertexId>;
+
+    explicit BinaryHeap(size_t /*vertex_count*/) {
+    }
+
+    bool Empty() const {
+        return heap_.empty();
+    }
+
+    void Push(Weight weight, VertexId vertex) {
+        heap_.push({weight, vertex});
+    }
+
+    Item Pop() {
+        const Item item = heap_.top();
+        heap_.pop();
+        return item;
+    }
+
+private:
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap_;
+};
+
+//4-ary heap with decrease-key: one entry per vertex, no stale ones, half as deep as a binary heap.
+//Heap positions are indexed by vertex id -> O(vertex_count) memory per search.
+//Pops in the same (weight, vertex) order as BinaryHeap
+template <typename Weight>
+class QuaternaryHeap {
+public:
+    using Item = std::pair<Weight, VertexId>;
+
+    explicit QuaternaryHeap(size_t vertex_count)
+        : positions_(vertex_count, NOT_QUEUED) {
+    }
+
+    bool Empty() const {
+        return heap_.empty();
+    }
+
+    void Push(Weight weight, VertexId vertex) {
+        size_t pos = positions_[vertex];
+        if (pos == NOT_QUEUED) {
+            pos = heap_.size();
+            heap_.push_back({weight, vertex});
+        } else if (weight < heap_[pos].first) {
+            heap_[pos].first = weight;
+        } else {
+            return;
+        }
+        SiftUp(pos);
+    }
+
+    Item Pop() {
+        const Item top = heap_.front();
+        positions_[top.second] = NOT_QUEUED;
+        const Item last = heap_.back();
+        heap_.pop_back();
+        if (!heap_.empty()) {
+            Place(0, last);
+            SiftDown(0);
+        }
+        return top;
+    }
+
+private:
+    static constexpr size_t ARITY = 4;
+    static constexpr uint32_t NOT_QUEUED = std::numeric_limits<uint32_t>::max();
+
+    void Place(size_t pos, const Item& item) {
+        heap_[pos] = item;
+        positions_[item.second] = static_cast<uint32_t>(pos);
+    }
+
+    void SiftUp(size_t pos) {
+        const Item item = heap_[pos];
+        while (pos > 0) {
+            const size_t parent = (pos - 1) / ARITY;
+            if (!(item < heap_[parent])) {
+                break;
+            }
+            Place(pos, heap_[parent]);
+            pos = parent;
+        }
+        Place(pos, item);
+    }
+
+    void SiftDown(size_t pos) {
+        const Item item = heap_[pos];
+        while (true) {
+            const size_t first_child = pos * ARITY + 1;
+            if (first_child >= heap_.size()) {
+                break;
+            }
+            const size_t child_end = std::min(first_child + ARITY, heap_.size());
+            size_t best = first_child;
+            for (size_t child = first_child + 1; child < child_end; ++child) {
+                if (heap_[child] < heap_[best]) {
+                    best = child;
+                }
+            }
+            if (!(heap_[best] < item)) {
+                break;
+            }
+            Place(pos, heap_[best]);
+            pos = best;
+        }
+        Place(pos, item);
+    }
+
+    std::vector<Item> heap_;
+    std::vector<uint32_t> positions_;
+};
+
+//Radix heap, unsigned integer weights only. Monotone: a pushed weight is never below the last
+//popped one, as in Dijkstra over non-negative edges (not in A* with an inconsistent potential).
+//Bucket i > 0 keeps weights whose highest bit differing from the last popped weight is bit i - 1,
+//an entry moves down at most once per bit -> O(bits) amortized per entry, no comparisons between entries.
+//Equal weights pop in no particular order, equally short routes may differ from the heaps' ones
+template <typename Weight>
+class RadixHeap {
+    static_assert(std::is_unsigned_v<Weight>, "RadixHeap: unsigned integer weights only");
+
+public:
+    using Item = std::pair<Weight, VertexId>;
+
+    explicit RadixHeap(size_t /*vertex_count*/) {
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    void Push(Weight weight, VertexId vertex) {
+        assert(!(weight < last_));
+        buckets_[GetBucket(weight)].push_back({weight, vertex});
+        ++size_;
+    }
+
+    Item Pop() {
+        if (buckets_[0].empty()) {
+            //smallest weight of the first non-empty bucket becomes the last one, its entries move down
+            size_t bucket = 1;
+            while (buckets_[bucket].empty()) {
+                ++bucket;
+            }
+            std::vector<Item>& items = buckets_[bucket];
+            last_ = std::min_element(items.begin(), items.end())->first;
+            for (const Item& item : items) {
+                buckets_[GetBucket(item.first)].push_back(item);
+            }
+            items.clear();
+        }
+        const Item item = buckets_[0].back();
+        buckets_[0].pop_back();
+        --size_;
+        return item;
+    }
+
+private:
+    static constexpr size_t BUCKET_COUNT = std::numeric_limits<Weight>::digits + 1;
+
+    size_t GetBucket(Weight weight) const {
+        return std::bit_width(static_cast<Weight>(weight ^ last_));
+    }
+
+    std::array<std::vector<Item>, BUCKET_COUNT> buckets_;
+    Weight last_ = 0;
+    size_t size_ = 0;
+};
+
+}  // namespace graph
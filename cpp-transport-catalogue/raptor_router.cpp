@@ -0,0 +1,233 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+
+RaptorRouter::RaptorRouter(const TransportDb& tdb, int wait_time, const TravelTime& travel_time)
+: wait_time_(wait_time) {
+    for(const auto& stop : tdb.GetAllStopsWithBuses()) {
+        stop_ids_[stop->name] = static_cast<StopId>(stops_.size());
+        stops_.push_back(stop);
+    }
+    for(const auto& bus : tdb.GetAllBusesWithStops()) {
+        const auto stops = bus->stops;
+        if(bus->is_roundtrip) {
+            AddChain(bus, stops, 0, stops.size(), travel_time);
+        } else {
+            //stops are stored there & back: A B C B A -> forward A B C, backward C B A
+            const size_t final_stop = stops.size() / 2;
+            AddChain(bus, stops, 0, final_stop + 1, travel_time);
+            AddChain(bus, stops, final_stop, stops.size(), travel_time);
+        }
+    }
+    BuildStopPositions();
+}
+
+RouteStat RaptorRouter::PlotRoute(std::string_view from, std::string_view to) const {
+    const StopId from_id = FindStop(from);
+    const StopId to_id = FindStop(to);
+    if(from_id == NO_STOP || to_id == NO_STOP) {
+        return {};
+    }
+    const Rounds rounds = Search(from_id, to_id);
+    return BuildRouteStat(rounds, rounds.arrivals.size() - 1, to_id);
+}
+
+std::vector<RouteStat> RaptorRouter::PlotRoutes(std::string_view from, const std::vector<std::string_view>& to_stops) const {
+    const StopId from_id = FindStop(from);
+    if(from_id == NO_STOP) {
+        return std::vector<RouteStat>(to_stops.size());
+    }
+    const Rounds rounds = Search(from_id, NO_STOP);
+    std::vector<RouteStat> stats;
+    stats.reserve(to_stops.size());
+    for(const auto to : to_stops) {
+        const StopId to_id = FindStop(to);
+        stats.push_back(to_id == NO_STOP ? RouteStat{} : BuildRouteStat(rounds, rounds.arrivals.size() - 1, to_id));
+    }
+    return stats;
+}
+
+std::vector<RouteStat> RaptorRouter::PlotParetoRoutes(std::string_view from, std::string_view to) const {
+    const StopId from_id = FindStop(from);
+    const StopId to_id = FindStop(to);
+    if(from_id == NO_STOP || to_id == NO_STOP) {
+        return {};
+    }
+    const Rounds rounds = Search(from_id, to_id);
+    std::vector<RouteStat> stats;
+    double best_time = UNREACHABLE;
+    for(size_t round = 0; round < rounds.arrivals.size(); ++round) {
+        if(rounds.arrivals[round][to_id] < best_time) {
+            best_time = rounds.arrivals[round][to_id];
+            stats.push_back(BuildRouteStat(rounds, round, to_id));
+        }
+    }
+    return stats;
+}
+
+std::optional<std::vector<ReachableStop>> RaptorRouter::FindReachable(std::string_view from, double max_time) const {
+    const StopId from_id = FindStop(from);
+    if(from_id == NO_STOP) {
+        return std::nullopt;
+    }
+    const Rounds rounds = Search(from_id, NO_STOP, max_time);
+    std::vector<ReachableStop> reachable;
+    for(StopId stop = 0; stop < stops_.size(); ++stop) {
+        if(rounds.arrivals.back()[stop] != UNREACHABLE) {
+            reachable.push_back({stops_[stop]->name, rounds.arrivals.back()[stop]});
+        }
+    }
+    return reachable;
+}
+
+void RaptorRouter::AddChain(BusPtr bus, std::span<const StopPtr> stops, size_t first, size_t last,
+                            const TravelTime& travel_time) {
+    //nowhere to ride
+    if(last <= first + 1) {
+        return;
+    }
+    Chain chain{bus, static_cast<Position>(chain_stops_.size()), 0};
+    for(size_t i = first; i < last; ++i) {
+        chain_stops_.push_back(stop_ids_.at(stops[i]->name));
+        chain_span_times_.push_back(i == first ? 0.0 : travel_time(stops[i - 1], stops[i]));
+        position_chains_.push_back(static_cast<uint32_t>(chains_.size()));
+    }
+    chain.end = static_cast<Position>(chain_stops_.size());
+    chains_.push_back(chain);
+}
+
+void RaptorRouter::BuildStopPositions() {
+    //counting sort of positions by stop
+    stop_position_offsets_.assign(stops_.size() + 1, 0);
+    for(const StopId stop : chain_stops_) {
+        ++stop_position_offsets_[stop + 1];
+    }
+    for(size_t stop = 0; stop < stops_.size(); ++stop) {
+        stop_position_offsets_[stop + 1] += stop_position_offsets_[stop];
+    }
+    stop_positions_.resize(chain_stops_.size());
+    std::vector<uint32_t> next(stop_position_offsets_.begin(), stop_position_offsets_.end() - 1);
+    for(Position pos = 0; pos < chain_stops_.size(); ++pos) {
+        stop_positions_[next[chain_stops_[pos]]++] = pos;
+    }
+}
+
+RaptorRouter::Rounds RaptorRouter::Search(StopId from, StopId target, double max_time) const {
+    Rounds rounds;
+    rounds.arrivals.emplace_back(stops_.size(), UNREACHABLE);
+    rounds.labels.emplace_back(stops_.size());
+    rounds.arrivals[0][from] = 0.0;
+
+    //stops improved in the previous round
+    std::vector<bool> marked(stops_.size(), false);
+    marked[from] = true;
+    //earliest position of every chain at a marked stop, chain end if none
+    std::vector<Position> first_positions(chains_.size());
+    for(uint32_t chain = 0; chain < chains_.size(); ++chain) {
+        first_positions[chain] = chains_[chain].end;
+    }
+    std::vector<uint32_t> chains_to_scan;
+
+    //a route never takes more buses than there are chains
+    for(size_t round = 1; round <= chains_.size(); ++round) {
+        chains_to_scan.clear();
+        for(StopId stop = 0; stop < stops_.size(); ++stop) {
+            if(!marked[stop]) {
+                continue;
+            }
+            marked[stop] = false;
+            for(uint32_t i = stop_position_offsets_[stop]; i < stop_position_offsets_[stop + 1]; ++i) {
+                const Position pos = stop_positions_[i];
+                const uint32_t chain = position_chains_[pos];
+                if(first_positions[chain] == chains_[chain].end) {
+                    chains_to_scan.push_back(chain);
+                }
+                first_positions[chain] = std::min(first_positions[chain], pos);
+            }
+        }
+        if(chains_to_scan.empty()) {
+            break;
+        }
+        rounds.arrivals.push_back(rounds.arrivals.back());
+        rounds.labels.emplace_back(stops_.size());
+        for(const uint32_t chain : chains_to_scan) {
+            ScanChain(chain, first_positions[chain], round, target, max_time, rounds, marked);
+            first_positions[chain] = chains_[chain].end;
+        }
+    }
+    return rounds;
+}
+
+void RaptorRouter::ScanChain(uint32_t chain, Position first, size_t round, StopId target, double max_time,
+                             Rounds& rounds, std::vector<bool>& marked) const {
+    const std::vector<double>& previous = rounds.arrivals[round - 1];
+    std::vector<double>& arrivals = rounds.arrivals[round];
+    std::vector<Label>& labels = rounds.labels[round];
+
+    //arrival at the current position staying on the bus, UNREACHABLE until boarded
+    double bus_time = UNREACHABLE;
+    Position board = first;
+    for(Position pos = first; pos < chains_[chain].end; ++pos) {
+        const StopId stop = chain_stops_[pos];
+        bus_time += chain_span_times_[pos];
+
+        //get off, if faster than known arrivals here & at the target
+        const double bound = target == NO_STOP ? arrivals[stop] : std::min(arrivals[stop], arrivals[target]);
+        if(bus_time < bound && bus_time <= max_time) {
+            arrivals[stop] = bus_time;
+            labels[stop] = {board, pos};
+            marked[stop] = true;
+        }
+        //get on here, if faster than staying on the bus from an earlier stop
+        if(previous[stop] + wait_time_ < bus_time) {
+            bus_time = previous[stop] + wait_time_;
+            board = pos;
+        }
+    }
+}
+
+RouteStat RaptorRouter::BuildRouteStat(const Rounds& rounds, size_t round, StopId to) const {
+    if(rounds.arrivals[round][to] == UNREACHABLE) {
+        return {};
+    }
+    RouteStat stat;
+    stat.exists = true;
+    stat.total_time = rounds.arrivals[round][to];
+
+    //rides from the last one, every ride starts where the previous round arrived
+    std::vector<Label> rides;
+    StopId stop = to;
+    while(round > 0) {
+        //round where the arrival was last improved
+        while(round > 0 && rounds.arrivals[round - 1][stop] == rounds.arrivals[round][stop]) {
+            --round;
+        }
+        if(round == 0) {
+            break;
+        }
+        const Label& label = rounds.labels[round][stop];
+        rides.push_back(label);
+        stop = chain_stops_[label.board];
+        --round;
+    }
+
+    for(auto it = rides.rbegin(); it != rides.rend(); ++it) {
+        double ride_time = 0.0;
+        for(Position pos = it->board + 1; pos <= it->alight; ++pos) {
+            ride_time += chain_span_times_[pos];
+        }
+        const Chain& chain = chains_[position_chains_[it->board]];
+        stat.items.push_back({RouteItemType::wait, stops_[chain_stops_[it->board]]->name, 1.0 * wait_time_});
+        stat.items.push_back({RouteItemType::bus, chain.bus->name, ride_time, static_cast<int>(it->alight - it->board)});
+    }
+    return stat;
+}
+
+RaptorRouter::StopId RaptorRouter::FindStop(std::string_view name) const {
+    const auto it = stop_ids_.find(name);
+    if(it == stop_ids_.end()) {
+        CERR << "*Warning: Router cannot find stop [" << name << "]\n";
+        return NO_STOP;
+    }
+    return it->second;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "domain.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//Round-based transit routing (RAPTOR) straight over Bus::stops, no graph.
+//Round k finds the fastest arrivals at every stop using at most k buses:
+//each bus direction ("chain") serving a stop improved in round k - 1 is scanned once from that stop,
+//boarding costs wait_time, riding costs the travel time of every passed span.
+//Chains are the same as in BusRouter: a roundtrip bus is one chain,
+//other buses have a forward & a backward chain, no riding through the final stop.
+//All data of a round is in flat arrays, chains of a round only read the previous round
+class RaptorRouter {
+public:
+    using TravelTime = std::function<double(StopPtr from, StopPtr to)>;
+
+    RaptorRouter(const TransportDb& tdb, int wait_time, const TravelTime& travel_time);
+
+    //Fastest route, same items as the graph engines of BusRouter
+    RouteStat PlotRoute(std::string_view from, std::string_view to) const;
+    //Fastest routes from one stop to many, in to_stops order, one search for all of them
+    std::vector<RouteStat> PlotRoutes(std::string_view from, const std::vector<std::string_view>& to_stops) const;
+    //Pareto set of (total time, transfers): fastest route for every bus count,
+    //which is faster than any route with fewer buses; ordered by bus count
+    std::vector<RouteStat> PlotParetoRoutes(std::string_view from, std::string_view to) const;
+    //Fastest arrivals at every stop within max_time, unordered; nullopt if 'from' is unknown
+    std::optional<std::vector<ReachableStop>> FindReachable(std::string_view from, double max_time) const;
+
+private:
+    using StopId = uint32_t;
+    //index in chain_stops_ & chain_span_times_
+    using Position = uint32_t;
+
+    static constexpr double UNREACHABLE = std::numeric_limits<double>::infinity();
+    static constexpr StopId NO_STOP = std::numeric_limits<StopId>::max();
+
+    struct Chain {
+        BusPtr bus = nullptr;
+        Position begin = 0;
+        Position end = 0;
+    };
+
+    //how a stop was reached in a round: by the chain of these positions
+    struct Label {
+        Position board = 0;
+        Position alight = 0;
+    };
+
+    //arrivals[k][stop]: fastest arrival using at most k buses,
+    //labels[k][stop] is set if arrivals[k][stop] < arrivals[k - 1][stop]
+    struct Rounds {
+        std::vector<std::vector<double>> arrivals;
+        std::vector<std::vector<Label>> labels;
+    };
+
+    int wait_time_ = 0;
+    std::vector<StopPtr> stops_;
+    std::unordered_map<std::string_view, StopId> stop_ids_;
+
+    std::vector<Chain> chains_;
+    std::vector<StopId> chain_stops_;
+    //travel time from the previous position of the chain, 0 for the first one
+    std::vector<double> chain_span_times_;
+    std::vector<uint32_t> position_chains_;
+
+    //positions of every stop in all chains: stop_positions_[stop_position_offsets_[stop]...]
+    std::vector<uint32_t> stop_position_offsets_;
+    std::vector<Position> stop_positions_;
+
+    void AddChain(BusPtr bus, std::span<const StopPtr> stops, size_t first, size_t last,
+                  const TravelTime& travel_time);
+    void BuildStopPositions();
+
+    //target pruning if target != NO_STOP, no arrivals later than max_time
+    Rounds Search(StopId from, StopId target, double max_time = UNREACHABLE) const;
+    void ScanChain(uint32_t chain, Position first, size_t round, StopId target, double max_time,
+                   Rounds& rounds, std::vector<bool>& marked) const;
+    //route ending at 'to' with arrivals[round][to]
+    RouteStat BuildRouteStat(const Rounds& rounds, size_t round, StopId to) const;
+    StopId FindStop(std::string_view name) const;
+};
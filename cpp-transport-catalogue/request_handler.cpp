@@ -30,6 +30,33 @@ RouteStat RequestHandler::GetRoute(int request_id, std::string_view from_stop, s
     return stat;
 }
 
+// Построить маршруты из одной остановки
+std::vector<RouteStat> RequestHandler::GetRoutes(const std::vector<int>& request_ids, std::string_view from_stop,
+                                                 const std::vector<std::string_view>& to_stops) const {
+    auto stats = router_.PlotRoutes(from_stop, to_stops);
+    for(size_t i = 0; i < stats.size(); ++i) {
+        stats[i].request_id = request_ids[i];
+    }
+    return stats;
+}
+
+// Построить таблицу времён в пути
+MatrixStat RequestHandler::GetMatrix(int request_id, const std::vector<std::string_view>& sources,
+                                     const std::vector<std::string_view>& targets) const {
+    auto stat = router_.PlotMatrix(sources, targets);
+    stat.request_id = request_id;
+    
+    return stat;
+}
+
+// Найти достижимые остановки
+ReachableStat RequestHandler::GetReachable(int request_id, std::string_view stop_name, double max_time) const {
+    auto stat = router_.PlotReachable(stop_name, max_time);
+    stat.request_id = request_id;
+    
+    return stat;
+}
+
 void RequestHandler::UploadRendererSettings(const std::shared_ptr<RendererSettings> settings) const {
     renderer_.LoadSettings(settings);
 }
@@ -38,8 +65,17 @@ void RequestHandler::UpdRouterSettings(BusRouterSettings settings) const {
     router_.UpdSettings(std::move(settings));
 }
 
+void RequestHandler::SaveRouter(const std::filesystem::path& file) const {
+    router_.SaveToFile(file);
+}
+
+void RequestHandler::LoadRouter(const std::filesystem::path& file) const {
+    router_.LoadFromFile(file);
+}
+
 // Отрисовать карту в поток
 void RequestHandler::RenderMap(std::ostream& out) const {
+    std::lock_guard lock(render_mutex_);
     //returns a set, so buses will be in alphabetical order
     renderer_.AddBusSet(tdb_.GetAllBusesWithStops());
     //stops in alphabetical order
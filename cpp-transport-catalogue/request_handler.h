@@ -4,7 +4,9 @@
 #include "transport_router.h"
 #include "transport_catalogue.h"
 
+#include <filesystem>
 #include <list>
+#include <mutex>
 #include <queue>
 #include <variant>
 
@@ -20,11 +22,26 @@ public:
     
     // Возвращает маршруты, проходящие через Stop
     RouteStat GetRoute(int request_id, std::string_view from_stop, std::string_view to_stop) const;
+    
+    // Маршруты из одной остановки во многие, request_ids[i] - запрос маршрута до to_stops[i]
+    std::vector<RouteStat> GetRoutes(const std::vector<int>& request_ids, std::string_view from_stop,
+                                     const std::vector<std::string_view>& to_stops) const;
+
+    // Таблица времён в пути из каждой остановки sources до каждой из targets (запрос Matrix)
+    MatrixStat GetMatrix(int request_id, const std::vector<std::string_view>& sources,
+                         const std::vector<std::string_view>& targets) const;
+
+    // Остановки, достижимые из stop_name не более чем за max_time минут (запрос Reachable)
+    ReachableStat GetReachable(int request_id, std::string_view stop_name, double max_time) const;
 
     void UploadRendererSettings(const std::shared_ptr<RendererSettings> settings) const;
     void UpdRouterSettings(BusRouterSettings settings) const;
     
-    // Отрисовать карту в svg документ
+    // Сохранить / загрузить таблицу маршрутов роутера
+    void SaveRouter(const std::filesystem::path& file) const;
+    void LoadRouter(const std::filesystem::path& file) const;
+    
+    // Отрисовать карту в svg документ, вызовы из разных потоков выполняются по очереди
     void RenderMap(std::ostream& out) const;
     
 private:
@@ -32,6 +49,8 @@ private:
     const TransportDb& tdb_;
     MapRenderer& renderer_;
     BusRouter& router_;
+    // MapRenderer накапливает данные карты -> один RenderMap за раз
+    mutable std::mutex render_mutex_;
     
     //void UploadBusData(MapRenderer& renderer_) const;
 };
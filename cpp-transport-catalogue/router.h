@@ -1,13 +1,18 @@
 #pragma once
 
 #include "graph.h"
+#include "min_plus.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 #include <iterator>
+#include <limits>
 #include <optional>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -20,7 +25,15 @@ private:
     using Graph = DirectedWeightedGraph<Weight>;
 
 public:
-    explicit Router(const Graph& graph);
+    //Routes table is stored as two flat vertex_count x vertex_count arrays (row = from, column = to):
+    //route weights, UNREACHABLE if there is no route, and last edges of the routes, NO_EDGE for none
+    using PrevEdgeId = uint32_t;
+    static constexpr PrevEdgeId NO_EDGE = std::numeric_limits<PrevEdgeId>::max();
+
+    //thread_count != 1 -> blocked Floyd-Warshall, independent tiles run in parallel (0 = all cores)
+    explicit Router(const Graph& graph, size_t thread_count = 1);
+    //Uses an already computed table, e.g. memory-mapped from a file, which must outlive the router
+    Router(const Graph& graph, const Weight* route_weights, const PrevEdgeId* prev_edges);
 
     struct RouteInfo {
         Weight weight;
@@ -29,89 +42,216 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    //Weight of the route only, no path reconstruction
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const {
+        const Weight weight = CheckedWeight(route_weights_view_[Cell(from, to)]);
+        return weight == UNREACHABLE ? std::nullopt : std::optional<Weight>(weight);
+    }
+
+    //Raw table, vertex_count x vertex_count cells each
+    size_t GetVertexCount() const {
+        return vertex_count_;
+    }
+    const Weight* GetRouteWeights() const {
+        return route_weights_view_;
+    }
+    const PrevEdgeId* GetPrevEdges() const {
+        return prev_edges_view_;
+    }
+
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
-    };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+
+    static constexpr Weight UNREACHABLE = WeightTraits<Weight>::UNREACHABLE;
+
+    size_t Cell(VertexId from, VertexId to) const {
+        return from * vertex_count_ + to;
+    }
+
+    //A loaded table is checked cell by cell when read, not at load: that would read every mapped page
+    static Weight CheckedWeight(Weight weight) {
+        if constexpr (std::is_floating_point_v<Weight>) {
+            if (std::isnan(weight) || weight < 0) {
+                throw std::runtime_error("Router: corrupted route weight");
+            }
+        }
+        return weight;
+    }
 
     void InitializeRoutesInternalData(const Graph& graph) {
-        const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+        if (graph.GetEdgeCount() >= NO_EDGE) {
+            throw std::length_error("Router: too many edges for 32-bit edge ids");
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            route_weights_[Cell(vertex, vertex)] = ZERO_WEIGHT;
             for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
                 const auto& edge = graph.GetEdge(edge_id);
                 if (edge.weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+                const size_t cell = Cell(vertex, edge.to);
+                if (edge.weight < route_weights_[cell]) {
+                    route_weights_[cell] = edge.weight;
+                    prev_edges_[cell] = static_cast<PrevEdgeId>(edge_id);
                 }
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                              route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    //Relaxes row vertex_from through vertex_through for columns [to_begin, to_end)
+    void RelaxRow(VertexId vertex_from, VertexId vertex_through, VertexId to_begin, VertexId to_end) {
+        const Weight weight_from = route_weights_[Cell(vertex_from, vertex_through)];
+        if (weight_from == UNREACHABLE) {
+            return;
+        }
+        const PrevEdgeId prev_edge_from = prev_edges_[Cell(vertex_from, vertex_through)];
+
+        Weight* row_weights = route_weights_.data() + Cell(vertex_from, 0);
+        PrevEdgeId* row_prev_edges = prev_edges_.data() + Cell(vertex_from, 0);
+        const Weight* through_weights = route_weights_.data() + Cell(vertex_through, 0);
+        const PrevEdgeId* through_prev_edges = prev_edges_.data() + Cell(vertex_through, 0);
+
+        //vectorized kernel, picked by the running CPU
+        if constexpr ((std::is_same_v<Weight, double> || std::is_same_v<Weight, uint32_t>)
+                      && std::is_same_v<PrevEdgeId, uint32_t>) {
+            RelaxRowMinPlus(weight_from, prev_edge_from, NO_EDGE,
+                            row_weights + to_begin, row_prev_edges + to_begin,
+                            through_weights + to_begin, through_prev_edges + to_begin, to_end - to_begin);
+        } else {
+            for (VertexId vertex_to = to_begin; vertex_to < to_end; ++vertex_to) {
+                //UNREACHABLE through_weights give an UNREACHABLE candidate, which never wins
+                const Weight candidate_weight = WeightTraits<Weight>::Add(weight_from, through_weights[vertex_to]);
+                if (candidate_weight < row_weights[vertex_to]) {
+                    row_weights[vertex_to] = candidate_weight;
+                    row_prev_edges[vertex_to] = through_prev_edges[vertex_to] != NO_EDGE
+                                              ? through_prev_edges[vertex_to]
+                                              : prev_edge_from;
+                }
+            }
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                    }
+    void RelaxRoutesInternalDataThroughVertex(VertexId vertex_through) {
+        for (VertexId vertex_from = 0; vertex_from < vertex_count_; ++vertex_from) {
+            RelaxRow(vertex_from, vertex_through, 0, vertex_count_);
+        }
+    }
+
+    //Blocked Floyd-Warshall over TILE_SIZE x TILE_SIZE tiles, for every diagonal block:
+    //1. the diagonal tile, 2. tiles in its row & column, 3. all remaining tiles.
+    //Gives the same route weights as the serial loop, but as paths are relaxed in a different
+    //order, an equally short route or a last-bit rounding difference is possible
+    void RelaxRoutesInternalDataBlocked(ThreadPool& pool) {
+        const size_t block_count = (vertex_count_ + TILE_SIZE - 1) / TILE_SIZE;
+        for (size_t block_through = 0; block_through < block_count; ++block_through) {
+            RelaxTile(block_through, block_through, block_through);
+
+            //tile i < block_count - 1: row tile, otherwise: column tile; skip the diagonal
+            pool.ParallelFor(2 * (block_count - 1), [&](size_t task) {
+                const size_t other_block = task % (block_count - 1);
+                const size_t block = other_block < block_through ? other_block : other_block + 1;
+                if (task < block_count - 1) {
+                    RelaxTile(block_through, block_through, block);
+                } else {
+                    RelaxTile(block_through, block, block_through);
                 }
+            });
+
+            pool.ParallelFor((block_count - 1) * (block_count - 1), [&](size_t task) {
+                size_t block_from = task / (block_count - 1);
+                size_t block_to = task % (block_count - 1);
+                block_from += block_from < block_through ? 0 : 1;
+                block_to += block_to < block_through ? 0 : 1;
+                RelaxTile(block_through, block_from, block_to);
+            });
+        }
+    }
+
+    void RelaxTile(size_t block_through, size_t block_from, size_t block_to) {
+        const VertexId through_end = std::min(vertex_count_, (block_through + 1) * TILE_SIZE);
+        const VertexId from_end = std::min(vertex_count_, (block_from + 1) * TILE_SIZE);
+        const VertexId to_end = std::min(vertex_count_, (block_to + 1) * TILE_SIZE);
+
+        for (VertexId vertex_through = block_through * TILE_SIZE; vertex_through < through_end; ++vertex_through) {
+            for (VertexId vertex_from = block_from * TILE_SIZE; vertex_from < from_end; ++vertex_from) {
+                RelaxRow(vertex_from, vertex_through, block_to * TILE_SIZE, to_end);
             }
         }
     }
 
+    static constexpr size_t TILE_SIZE = 64;
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
-    RoutesInternalData routes_internal_data_;
+    const size_t vertex_count_;
+    //own table, empty if an external one is used
+    std::vector<Weight> route_weights_;
+    std::vector<PrevEdgeId> prev_edges_;
+    //table used by BuildRoute: own or external
+    const Weight* route_weights_view_ = nullptr;
+    const PrevEdgeId* prev_edges_view_ = nullptr;
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+Router<Weight>::Router(const Graph& graph, size_t thread_count)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , vertex_count_(graph.GetVertexCount())
+    , route_weights_(vertex_count_ * vertex_count_, UNREACHABLE)
+    , prev_edges_(vertex_count_ * vertex_count_, NO_EDGE)
 {
     InitializeRoutesInternalData(graph);
 
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    if (thread_count != 1) {
+        ThreadPool pool(thread_count);
+        RelaxRoutesInternalDataBlocked(pool);
+    } else {
+        for (VertexId vertex_through = 0; vertex_through < vertex_count_; ++vertex_through) {
+            RelaxRoutesInternalDataThroughVertex(vertex_through);
+        }
     }
+    route_weights_view_ = route_weights_.data();
+    prev_edges_view_ = prev_edges_.data();
+}
+
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, const Weight* route_weights, const PrevEdgeId* prev_edges)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , route_weights_view_(route_weights)
+    , prev_edges_view_(prev_edges)
+{
 }
 
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Router: vertex id is out of range");
+    }
+    const Weight weight = CheckedWeight(route_weights_view_[Cell(from, to)]);
+    if (weight == UNREACHABLE) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
+    //the route back from to: the last edge of the route to vertex ends at vertex
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+    VertexId vertex = to;
+    for (PrevEdgeId edge_id = prev_edges_view_[Cell(from, to)]; edge_id != NO_EDGE;
+         edge_id = prev_edges_view_[Cell(from, vertex)])
     {
-        edges.push_back(*edge_id);
+        if (edge_id >= graph_.GetEdgeCount() || graph_.GetEdge(edge_id).to != vertex) {
+            throw std::runtime_error("Router: corrupted prev edge");
+        }
+        //a route has at most vertex_count_ - 1 edges, more -> a prev edges cycle (a corrupted loaded table)
+        if (edges.size() >= vertex_count_) {
+            throw std::runtime_error("Router: prev edges of the route form a cycle");
+        }
+        edges.push_back(edge_id);
+        vertex = graph_.GetEdge(edge_id).from;
+    }
+    if (vertex != from) {
+        throw std::runtime_error("Router: corrupted prev edge");
     }
     std::reverse(edges.begin(), edges.end());
 
     return RouteInfo{weight, std::move(edges)};
 }
 
-}  // namespace graph
\ No newline at end of file
+}  // namespace graph
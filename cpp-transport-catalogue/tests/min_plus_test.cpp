@@ -0,0 +1,120 @@
+#include "../min_plus.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+//Every vectorized RelaxRowMinPlus kernel the CPU supports against the plain loop, on random rows:
+//+inf / UINT32_MAX cells, wrapping integer sums, NO_EDGE prev edges, counts off the vector width
+//and the from == through row of Floyd-Warshall (row & through arrays are the same)
+
+namespace {
+
+constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+int failures = 0;
+
+void Fail(const char* kernel, const char* weights, size_t count, bool aliased, int round) {
+    std::fprintf(stderr, "FAILED: %s kernel, %s weights, count %zu, aliased %d, round %d\n",
+                 kernel, weights, count, aliased ? 1 : 0, round);
+    ++failures;
+}
+
+uint32_t RandomPrevEdge(std::mt19937_64& random) {
+    return random() % 4 == 0 ? NO_EDGE : static_cast<uint32_t>(random() % 1000);
+}
+
+double RandomWeight(std::mt19937_64& random) {
+    switch (random() % 8) {
+        case 0:
+            return INF;
+        case 1:
+            return 0.0;
+        case 2:
+            //few distinct values -> equal candidate & row weights, which must not win
+            return static_cast<double>(random() % 4);
+        default:
+            return std::uniform_real_distribution<double>(0.0, 100.0)(random);
+    }
+}
+
+uint32_t RandomIntWeight(std::mt19937_64& random) {
+    switch (random() % 8) {
+        case 0:
+            return UINT32_MAX;
+        case 1:
+            return 0;
+        case 2:
+            return static_cast<uint32_t>(random() % 4);
+        case 3:
+            //sums of two of these wrap around
+            return UINT32_MAX - static_cast<uint32_t>(random() % 1000);
+        default:
+            return static_cast<uint32_t>(random());
+    }
+}
+
+template <typename Weight, typename Relax, typename RandomWeightFunc>
+void CheckKernel(const char* name, const char* weights_name, Relax relax, Relax scalar,
+                 RandomWeightFunc random_weight, std::mt19937_64& random) {
+    for(int round = 0; round < 200; ++round) {
+        //0 .. 3 vectors of the widest kernel (16 cells) + any tail
+        const size_t count = random() % 53;
+        const bool aliased = random() % 4 == 0;
+        const Weight weight_from = aliased && random() % 2 == 0 ? Weight{0} : random_weight(random);
+        const uint32_t prev_edge_from = RandomPrevEdge(random);
+
+        std::vector<Weight> row_weights(count), through_weights(count);
+        std::vector<uint32_t> row_prev_edges(count), through_prev_edges(count);
+        for(size_t i = 0; i < count; ++i) {
+            row_weights[i] = random_weight(random);
+            through_weights[i] = random_weight(random);
+            row_prev_edges[i] = RandomPrevEdge(random);
+            through_prev_edges[i] = RandomPrevEdge(random);
+        }
+
+        auto expected_weights = row_weights;
+        auto expected_prev_edges = row_prev_edges;
+        auto actual_weights = row_weights;
+        auto actual_prev_edges = row_prev_edges;
+        if(aliased) {
+            scalar(weight_from, prev_edge_from, NO_EDGE, expected_weights.data(), expected_prev_edges.data(),
+                   expected_weights.data(), expected_prev_edges.data(), count);
+            relax(weight_from, prev_edge_from, NO_EDGE, actual_weights.data(), actual_prev_edges.data(),
+                  actual_weights.data(), actual_prev_edges.data(), count);
+        } else {
+            scalar(weight_from, prev_edge_from, NO_EDGE, expected_weights.data(), expected_prev_edges.data(),
+                   through_weights.data(), through_prev_edges.data(), count);
+            relax(weight_from, prev_edge_from, NO_EDGE, actual_weights.data(), actual_prev_edges.data(),
+                  through_weights.data(), through_prev_edges.data(), count);
+        }
+        //bitwise: +inf, -0.0 & co. included
+        if(std::memcmp(expected_weights.data(), actual_weights.data(), count * sizeof(Weight)) != 0
+           || expected_prev_edges != actual_prev_edges) {
+            Fail(name, weights_name, count, aliased, round);
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    const auto kernels = graph::GetMinPlusKernels();
+    const auto& scalar = kernels.front();
+    std::mt19937_64 random(20261017);
+    for(const auto& kernel : kernels) {
+        std::printf("min_plus kernel %s\n", kernel.name);
+        CheckKernel<double>(kernel.name, "double", kernel.relax, scalar.relax, RandomWeight, random);
+        CheckKernel<uint32_t>(kernel.name, "uint32", kernel.relax_int, scalar.relax_int, RandomIntWeight, random);
+    }
+    if(failures > 0) {
+        std::fprintf(stderr, "%d failures\n", failures);
+        return 1;
+    }
+    std::printf("OK\n");
+    return 0;
+}
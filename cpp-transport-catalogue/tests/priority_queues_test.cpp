@@ -0,0 +1,164 @@
+//CERR of graph.h
+#include "../domain.h"
+#include "../priority_queues.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+//Queue policies against BinaryHeap on random monotone push / pop sequences, as Dijkstra runs them:
+//pushed weights are never below the last popped one, queued vertices are pushed again
+//with smaller (decrease-key) and larger weights
+
+namespace {
+
+int failures = 0;
+
+void Fail(const char* queue, int round, const char* what) {
+    std::fprintf(stderr, "FAILED: %s, round %d: %s\n", queue, round, what);
+    ++failures;
+}
+
+//push a vertex with the weight last settled + delta, or pop
+struct Operation {
+    bool is_pop = false;
+    graph::VertexId vertex = 0;
+    uint32_t delta = 0;
+};
+
+std::vector<Operation> MakeOperations(std::mt19937_64& random, size_t vertex_count) {
+    std::vector<Operation> operations;
+    const size_t count = 1 + random() % 600;
+    //few distinct deltas -> equal weights
+    const uint32_t max_delta = random() % 2 == 0 ? 4 : 1000;
+    for(size_t i = 0; i < count; ++i) {
+        if(random() % 3 == 0) {
+            operations.push_back({true});
+        } else {
+            operations.push_back({false, random() % vertex_count, static_cast<uint32_t>(random() % max_delta)});
+        }
+    }
+    return operations;
+}
+
+struct SearchResult {
+    //settled (weight, vertex) in pop order
+    std::vector<std::pair<uint32_t, graph::VertexId>> settled;
+    //every settled vertex had the smallest weight pushed for it & among the unsettled ones
+    bool pops_minimum = true;
+};
+
+//A vertex is pushed while unsettled only, its stale entries are skipped
+template <typename Queue>
+SearchResult RunSearch(const std::vector<Operation>& operations, size_t vertex_count) {
+    constexpr uint32_t NOT_PUSHED = UINT32_MAX;
+    Queue queue(vertex_count);
+    std::vector<bool> settled(vertex_count, false);
+    //smallest pushed weight of the unsettled vertices
+    std::vector<uint32_t> best(vertex_count, NOT_PUSHED);
+    SearchResult result;
+    //unsettled vertices in the queue
+    size_t queued = 0;
+    uint32_t last = 0;
+    //settles one queued vertex, skipping stale entries
+    auto pop = [&] {
+        while(!queue.Empty()) {
+            const auto [weight, vertex] = queue.Pop();
+            if(settled[vertex]) {
+                continue;
+            }
+            for(graph::VertexId other = 0; other < vertex_count; ++other) {
+                if(!settled[other] && best[other] < weight) {
+                    result.pops_minimum = false;
+                }
+            }
+            if(weight != best[vertex]) {
+                result.pops_minimum = false;
+            }
+            settled[vertex] = true;
+            best[vertex] = NOT_PUSHED;
+            --queued;
+            last = weight;
+            result.settled.push_back({weight, vertex});
+            return;
+        }
+    };
+    for(const auto& operation : operations) {
+        if(operation.is_pop) {
+            //only stale entries left -> nothing to settle, they stay queued
+            if(queued > 0) {
+                pop();
+            }
+        } else if(!settled[operation.vertex]) {
+            const uint32_t weight = last + operation.delta;
+            queued += best[operation.vertex] == NOT_PUSHED ? 1 : 0;
+            best[operation.vertex] = std::min(best[operation.vertex], weight);
+            queue.Push(weight, operation.vertex);
+        }
+    }
+    while(queued > 0) {
+        pop();
+    }
+    return result;
+}
+
+//Every entry in pop order, stale ones included
+template <typename Queue>
+std::vector<uint32_t> RunRaw(const std::vector<Operation>& operations, size_t vertex_count) {
+    Queue queue(vertex_count);
+    std::vector<uint32_t> weights;
+    uint32_t last = 0;
+    for(const auto& operation : operations) {
+        if(operation.is_pop) {
+            if(!queue.Empty()) {
+                last = queue.Pop().first;
+                weights.push_back(last);
+            }
+        } else {
+            queue.Push(last + operation.delta, operation.vertex);
+        }
+    }
+    while(!queue.Empty()) {
+        weights.push_back(queue.Pop().first);
+    }
+    return weights;
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 random(20261017);
+    for(int round = 0; round < 500; ++round) {
+        //few vertices -> many pushes of already queued ones
+        const size_t vertex_count = 1 + random() % 40;
+        const auto operations = MakeOperations(random, vertex_count);
+
+        const auto expected = RunSearch<graph::BinaryHeap<uint32_t>>(operations, vertex_count);
+        if(!expected.pops_minimum) {
+            Fail("BinaryHeap", round, "settled a vertex above the minimum");
+        }
+        const auto quaternary = RunSearch<graph::QuaternaryHeap<uint32_t>>(operations, vertex_count);
+        if(quaternary.settled != expected.settled) {
+            Fail("QuaternaryHeap", round, "settled (weight, vertex) order differs");
+        }
+        //equal weights pop in no particular order, later pushes depend on which vertex settled first ->
+        //minimum weights only
+        if(!RunSearch<graph::RadixHeap<uint32_t>>(operations, vertex_count).pops_minimum) {
+            Fail("RadixHeap", round, "settled a vertex above the minimum");
+        }
+        //both keep stale entries -> every popped weight too
+        if(RunRaw<graph::RadixHeap<uint32_t>>(operations, vertex_count)
+           != RunRaw<graph::BinaryHeap<uint32_t>>(operations, vertex_count)) {
+            Fail("RadixHeap", round, "popped weights differ");
+        }
+    }
+    if(failures > 0) {
+        std::fprintf(stderr, "%d failures\n", failures);
+        return 1;
+    }
+    std::printf("OK\n");
+    return 0;
+}
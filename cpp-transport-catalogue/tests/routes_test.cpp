@@ -0,0 +1,158 @@
+#include "../benchmark/city_generator.h"
+#include "../json_reader.h"
+#include "../map_renderer.h"
+#include "../request_handler.h"
+#include "../transport_catalogue.h"
+#include "../transport_router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//End to end: the Route answers of a synthetic city, JsonReader -> TransportDb -> BusRouter -> json,
+//for every router_type & graph_model against all_pairs on stop_pairs, then through a saved & loaded
+//all_pairs router. Built for double & centiminute route weights (TRANSPORT_CENTIMINUTE_WEIGHTS)
+
+namespace {
+
+int failures = 0;
+
+void Fail(const std::string& engine, int request_id, const char* what) {
+    std::fprintf(stderr, "FAILED: %s, request %d: %s\n", engine.c_str(), request_id, what);
+    ++failures;
+}
+
+struct RouteAnswer {
+    int request_id = 0;
+    std::optional<double> total_time;
+    size_t item_count = 0;
+};
+
+bench::CityConfig MakeConfig(const std::string& router_type, const std::string& graph_model) {
+    bench::CityConfig config;
+    config.stop_count = 200;
+    config.bus_count = 30;
+    config.request_count = 300;
+    config.mix = {0, 0, 1, 0, 0};
+    config.map_requests = 0;
+    config.seed = 7;
+    config.router_type = router_type;
+    config.graph_model = graph_model;
+    return config;
+}
+
+std::vector<RouteAnswer> ParseAnswers(const std::string& answers) {
+    std::istringstream in(answers);
+    const auto document = json::Load(in);
+    std::vector<RouteAnswer> result;
+    for(const auto& node : document.GetRoot().AsArray()) {
+        const auto& answer = node.AsMap();
+        RouteAnswer route;
+        route.request_id = answer.at("request_id").AsInt();
+        if(answer.count("total_time") > 0) {
+            route.total_time = answer.at("total_time").AsDouble();
+            route.item_count = answer.at("items").AsArray().size();
+        }
+        result.push_back(route);
+    }
+    return result;
+}
+
+//Answers of the generated city; save_file: saves the router after the requests,
+//load_file: loads the router before them
+std::string RunCity(const bench::CityConfig& config, const std::filesystem::path& save_file = {},
+                    const std::filesystem::path& load_file = {}) {
+    std::ostringstream input;
+    json::Print(bench::GenerateCity(config), input);
+
+    TransportDb database;
+    MapRenderer map_renderer;
+    BusRouter router(database);
+    RequestHandler request_handler(database, map_renderer, router);
+    JsonReader jreader(database, request_handler);
+
+    std::istringstream in(input.str());
+    jreader.ParseInput(in);
+    if(!load_file.empty()) {
+        router.LoadFromFile(load_file);
+    }
+    jreader.ProcessStatRequests();
+    if(!save_file.empty()) {
+        router.SaveToFile(save_file);
+    }
+    std::ostringstream out;
+    jreader.PrintRequestAnswers(out);
+    return out.str();
+}
+
+//Optimal routes may differ between engines, their times may not. Answers are printed with 6 significant
+//digits; integer weights round every ride to a hundredth of a minute, the chosen route may be
+//a few hundredths off the double optimum
+void CompareAnswers(const std::string& engine, const std::vector<RouteAnswer>& expected,
+                    const std::vector<RouteAnswer>& actual) {
+    if(expected.size() != actual.size()) {
+        Fail(engine, 0, "answer count differs");
+        return;
+    }
+    for(size_t i = 0; i < expected.size(); ++i) {
+        if(expected[i].request_id != actual[i].request_id) {
+            Fail(engine, actual[i].request_id, "request order differs");
+        } else if(expected[i].total_time.has_value() != actual[i].total_time.has_value()) {
+            Fail(engine, actual[i].request_id, "route found by one engine only");
+        } else if(expected[i].total_time) {
+            double tolerance = 2e-5 * std::max(1.0, *expected[i].total_time);
+            if(CENTIMINUTE_WEIGHTS) {
+                tolerance += 0.01 * static_cast<double>(expected[i].item_count + actual[i].item_count);
+            }
+            if(std::abs(*expected[i].total_time - *actual[i].total_time) > tolerance) {
+                Fail(engine, actual[i].request_id, "total_time differs");
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    std::printf("%s route weights\n", CENTIMINUTE_WEIGHTS ? "centiminute" : "double");
+    const auto expected = ParseAnswers(RunCity(MakeConfig("all_pairs", "stop_pairs")));
+    size_t found = 0;
+    for(const auto& answer : expected) {
+        found += answer.total_time ? 1 : 0;
+    }
+    if(found == 0 || found == expected.size()) {
+        Fail("all_pairs", 0, "expected both found & missing routes");
+    }
+
+    for(const std::string router_type : {"all_pairs", "dijkstra", "contraction_hierarchy", "astar", "alt", "raptor"}) {
+        for(const std::string graph_model : {"stop_pairs", "linear"}) {
+            const auto answers = RunCity(MakeConfig(router_type, graph_model));
+            CompareAnswers(router_type + "/" + graph_model, expected, ParseAnswers(answers));
+        }
+    }
+
+    //make_base & process_requests: the loaded router answers exactly as the saved one did
+    const auto file = std::filesystem::temp_directory_path()
+        / ("routes_test_" + std::to_string(CENTIMINUTE_WEIGHTS ? 1 : 0) + ".bin");
+    for(const std::string graph_model : {"stop_pairs", "linear"}) {
+        const auto config = MakeConfig("all_pairs", graph_model);
+        const auto saved = RunCity(config, file);
+        const auto loaded = RunCity(config, {}, file);
+        if(saved != loaded) {
+            Fail("all_pairs/" + graph_model + " saved & loaded", 0, "answers differ");
+        }
+    }
+    std::filesystem::remove(file);
+
+    if(failures > 0) {
+        std::fprintf(stderr, "%d failures\n", failures);
+        return 1;
+    }
+    std::printf("OK\n");
+    return 0;
+}
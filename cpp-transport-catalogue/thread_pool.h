@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed set of worker threads running one index range at a time.
+//The calling thread takes part in the work; ParallelFor is not reentrant
+//(must not be called from inside a task of the same pool)
+class ThreadPool {
+public:
+    //thread_count == 0 -> one thread per hardware core
+    explicit ThreadPool(size_t thread_count = 0) {
+        if(thread_count == 0) {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        //the caller is the first thread
+        for(size_t i = 1; i < thread_count; ++i) {
+            workers_.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        job_cv_.notify_all();
+        for(auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t GetThreadCount() const {
+        return workers_.size() + 1;
+    }
+
+    //Calls func(index) for every index in [0, count) and waits for all of them,
+    //the first exception thrown by a task is rethrown here
+    template <typename Func>
+    void ParallelFor(size_t count, Func&& func) {
+        if(count == 0) {
+            return;
+        }
+        if(workers_.empty() || count == 1) {
+            for(size_t index = 0; index < count; ++index) {
+                func(index);
+            }
+            return;
+        }
+        std::lock_guard dispatch_lock(dispatch_mutex_);
+
+        const std::function<void(size_t)> task = [&func](size_t index) { func(index); };
+        Job job(task, count);
+        {
+            std::lock_guard lock(mutex_);
+            job_ = &job;
+            ++generation_;
+        }
+        job_cv_.notify_all();
+        RunJob(job);
+        {
+            std::unique_lock lock(mutex_);
+            done_cv_.wait(lock, [this] { return active_workers_ == 0; });
+            job_ = nullptr;
+        }
+        if(job.error) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    struct Job {
+        Job(const std::function<void(size_t)>& job_task, size_t job_count)
+        : task(job_task)
+        , count(job_count) {
+        }
+        const std::function<void(size_t)>& task;
+        const size_t count;
+        std::atomic<size_t> next_index = 0;
+        std::mutex error_mutex;
+        std::exception_ptr error = nullptr;
+    };
+
+    static void RunJob(Job& job) {
+        for(size_t index = job.next_index++; index < job.count; index = job.next_index++) {
+            try {
+                job.task(index);
+            } catch(...) {
+                std::lock_guard lock(job.error_mutex);
+                if(!job.error) {
+                    job.error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void WorkerLoop() {
+        size_t seen_generation = 0;
+        while(true) {
+            std::unique_lock lock(mutex_);
+            job_cv_.wait(lock, [this, &seen_generation] {
+                return stop_ || (job_ != nullptr && generation_ != seen_generation);
+            });
+            if(stop_) {
+                return;
+            }
+            seen_generation = generation_;
+            Job* job = job_;
+            ++active_workers_;
+            lock.unlock();
+
+            RunJob(*job);
+
+            lock.lock();
+            --active_workers_;
+            done_cv_.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+
+    std::mutex dispatch_mutex_;
+    std::mutex mutex_;
+    std::condition_variable job_cv_;
+    std::condition_variable done_cv_;
+
+    Job* job_ = nullptr;
+    size_t generation_ = 0;
+    size_t active_workers_ = 0;
+    bool stop_ = false;
+};
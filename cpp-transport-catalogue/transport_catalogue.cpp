@@ -1,7 +1,12 @@
 #include "transport_catalogue.h"
+#include "thread_pool.h"
 
+#include <algorithm>
 #include <limits>
 #include <ranges>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
 using std::string;
 using std::string_view;
 using std::vector;
@@ -9,50 +14,148 @@ using std::vector;
 //DEBUG
 #include <iostream>
 
-StopPtr TransportDb::AddStop(std::string stop_name, geo::Coord coords) {
-    Stop* added_stop = new Stop(std::move(stop_name), coords);
+//arena_ never runs destructors
+static_assert(std::is_trivially_destructible_v<Stop> && std::is_trivially_destructible_v<Bus>);
+
+StopPtr TransportDb::AddStop(std::string_view stop_name, geo::Coord coords) {
+    const auto id = static_cast<uint32_t>(stops_.size());
+    Stop* added_stop = std::pmr::polymorphic_allocator<>(&arena_).new_object<Stop>(Stop{AddName(stop_name), coords, id});
     stop_index_[added_stop->name] = added_stop;
+    stops_.push_back(added_stop);
+    is_finalized_ = false;
+    ++revision_;
     return added_stop;
 }
 
-BusPtr TransportDb::AddBus(std::string bus_name, const std::vector<std::string_view>& stops, bool is_roundtrip, std::string_view final_stop) {
+BusPtr TransportDb::AddBus(std::string_view bus_name, const std::vector<std::string_view>& stops, bool is_roundtrip, std::string_view final_stop) {
     
     //TODO: Add final_stop presence in index check?
     StopPtr final_stop_ptr = final_stop.empty() ? nullptr : stop_index_.at(final_stop);
 
-    Bus* added_bus = new Bus(std::move(bus_name), GetStopPtrs(stops), is_roundtrip, final_stop_ptr);
+    const auto id = static_cast<uint32_t>(buses_.size());
+    Bus* added_bus = std::pmr::polymorphic_allocator<>(&arena_).new_object<Bus>(
+        Bus{AddName(bus_name), AddStopPtrs(stops), is_roundtrip, final_stop_ptr, id});
     bus_index_[added_bus->name] = added_bus;
+    buses_.push_back(added_bus);
     AddBusToStops(added_bus);
+    is_finalized_ = false;
+    ++revision_;
     return added_bus;
 }
 
-void TransportDb::SetRoadDistance(std::string_view from_stop_name, std::string_view to_stop_name, int dist) const {
+void TransportDb::SetRoadDistance(std::string_view from_stop_name, std::string_view to_stop_name, int dist) {
     if(stop_index_.count(from_stop_name) > 0 && stop_index_.count(to_stop_name) > 0) {
-        road_distance_table_[{stop_index_.at(from_stop_name), stop_index_.at(to_stop_name)}] = dist;
+        road_distances_set_.push_back({stop_index_.at(from_stop_name)->id, stop_index_.at(to_stop_name)->id, dist});
+        is_finalized_ = false;
+        ++revision_;
     } else {
         //DEBUG:
         CERR_ERROR << "Could not add road_dist between stops: " << from_stop_name << " & " << to_stop_name << std::endl;
     }
 }
 
+void TransportDb::Finalize(size_t thread_count) {
+    is_finalized_ = false;
+    FinalizeRoadDistances();
+    
+    segment_offsets_.assign(buses_.size() + 1, 0);
+    for(size_t id = 0; id < buses_.size(); ++id) {
+        segment_offsets_[id + 1] = segment_offsets_[id] + std::max<size_t>(buses_[id]->stops.size(), 1) - 1;
+    }
+    segment_geo_lengths_.assign(segment_offsets_.back(), 0.0);
+    bus_stats_.assign(buses_.size(), {});
+    
+    //buses are independent, each writes its own segments & slot
+    ThreadPool pool(thread_count);
+    pool.ParallelFor(buses_.size(), [this](size_t id) {
+        const auto& stops = buses_[id]->stops;
+        for(size_t i = 1; i < stops.size(); ++i) {
+            segment_geo_lengths_[segment_offsets_[id] + i - 1] = geo::ComputeDistance(stops[i - 1]->location, stops[i]->location);
+        }
+        bus_stats_[id] = ComputeBusStat(buses_[id]);
+    });
+    is_finalized_ = true;
+}
+
+void TransportDb::FinalizeRoadDistances() {
+    auto by_stops = [](const RoadDistance& lhs, const RoadDistance& rhs) {
+        return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+    };
+    //1.Given distances, the last one set for a pair
+    std::vector<RoadDistance> distances = road_distances_set_;
+    std::stable_sort(distances.begin(), distances.end(), by_stops);
+    std::vector<RoadDistance> given;
+    given.reserve(distances.size());
+    for(size_t i = 0; i < distances.size(); ++i) {
+        if(i + 1 == distances.size() || by_stops(distances[i], distances[i + 1])) {
+            given.push_back(distances[i]);
+        }
+    }
+    //2.Reverse fallbacks: to -> from is from -> to, if not given itself
+    distances = given;
+    for(const auto& road : given) {
+        const RoadDistance reverse{road.to, road.from, road.distance};
+        if(!std::binary_search(given.begin(), given.end(), reverse, by_stops)) {
+            distances.push_back(reverse);
+        }
+    }
+    std::sort(distances.begin(), distances.end(), by_stops);
+    
+    //3.Compressed sparse rows by from stop
+    road_offsets_.assign(stops_.size() + 1, 0);
+    for(const auto& road : distances) {
+        ++road_offsets_[road.from + 1];
+    }
+    for(size_t id = 0; id < stops_.size(); ++id) {
+        road_offsets_[id + 1] += road_offsets_[id];
+    }
+    road_neighbours_.clear();
+    road_neighbours_.reserve(distances.size());
+    for(const auto& road : distances) {
+        road_neighbours_.push_back({road.to, road.distance});
+    }
+}
+
 BusStat TransportDb::GetBusStat(string_view bus_name) const {
-    if(bus_index_.count(bus_name) == 0) {
+    if(!is_finalized_) {
+        throw std::logic_error("TransportDb::GetBusStat: Finalize() the database first");
+    }
+    auto it = bus_index_.find(bus_name);
+    if(it == bus_index_.end()) {
         return {}; //empty BusStat with bool exists = 0;
     }
+    return bus_stats_[it->second->id];
+}
+
+std::span<const double> TransportDb::GetSegmentGeoLengths(BusPtr bus) const {
+    if(!is_finalized_) {
+        throw std::logic_error("TransportDb::GetSegmentGeoLengths: Finalize() the database first");
+    }
+    return {segment_geo_lengths_.data() + segment_offsets_[bus->id], segment_offsets_[bus->id + 1] - segment_offsets_[bus->id]};
+}
+
+//Runs concurrently for different buses in Finalize(): reads the road adjacency & the bus's own segments only
+BusStat TransportDb::ComputeBusStat(BusPtr bus) const {
     BusStat stat;
-    auto bus = bus_index_.at(bus_name);
-    
     stat.exists = true;
     stat.total_stops = static_cast<int>(bus->stops.size());
-    stat.unique_stops = static_cast<int>(GetUniqueStops(bus).size());
+    
+    std::vector<uint32_t> stop_ids;
+    stop_ids.reserve(bus->stops.size());
+    for(const auto& stop : bus->stops) {
+        stop_ids.push_back(stop->id);
+    }
+    std::sort(stop_ids.begin(), stop_ids.end());
+    stat.unique_stops = static_cast<int>(std::unique(stop_ids.begin(), stop_ids.end()) - stop_ids.begin());
     
     //prev stop in bus for distance calculation
     StopPtr prev_stop = bus->stops.empty() ? nullptr : bus->stops[0];
+    const double* segment_geo_length = segment_geo_lengths_.data() + segment_offsets_[bus->id];
     double bus_geo_length = 0.0;
     //start at stop #2
     for(const auto& stop : bus->stops | std::views::drop(1)) {
-        bus_geo_length += GetGeoDistance(prev_stop, stop);
-        stat.road_dist += GetRoadDistance(prev_stop, stop);
+        bus_geo_length += *segment_geo_length++;
+        stat.road_dist += FindRoadDistance(prev_stop, stop);
 
         prev_stop = stop;
     }
@@ -126,15 +229,7 @@ double TransportDb::GetGeoDistance(StopPtr from, StopPtr to) const {
         CERR_ERROR << "*Error, GeoDistance: invalid stop pointers passed\n";
         return 0.0;
     }
-    //use pair for convenience
-    auto stop_pair = std::make_pair(from, to);
-    if(geo_distance_table_.count(stop_pair) > 0) {
-        return geo_distance_table_.at(stop_pair);
-    }
-    //compute if not found
-    double dist = geo::ComputeDistance(from->location, to->location);
-    geo_distance_table_[stop_pair] = dist;
-    return dist;
+    return geo::ComputeDistance(from->location, to->location);
 }
 
 //All distances are whole positive numbers -> int or size_t
@@ -144,22 +239,22 @@ int TransportDb::GetRoadDistance(StopPtr from, StopPtr to) const {
         CERR_ERROR << "*Error, RoadDistance: invalid stop pointers passed\n";
         return 0;
     }
-    auto it = road_distance_table_.find({from, to});
-    
-    //if from - to not found, use to - from dist
-    if(it == road_distance_table_.end()) {
-        //CERR << "#Warning, RoadDistance: used Reverse Distance\n";
-        it = road_distance_table_.find({to, from});
+    if(!is_finalized_) {
+        throw std::logic_error("TransportDb::GetRoadDistance: Finalize() the database first");
     }
-    //DEBUG
-    if(it == road_distance_table_.end()) {
-        //CERR_ERROR << " ERROR: No stop distance found for stops [" << from->name << "] & [" << to->name << "]" << std::endl;
-    }
-    return it == road_distance_table_.end() ? std::numeric_limits<int>::max() : it->second;
+    return FindRoadDistance(from, to);
 }
 
-std::unordered_set<StopPtr> TransportDb::GetUniqueStops(BusPtr bus) const {
-    return {bus->stops.begin(), bus->stops.end()};
+int TransportDb::FindRoadDistance(StopPtr from, StopPtr to) const {
+    //a few neighbours per stop, reverse fallbacks are resolved by Finalize()
+    for(uint32_t pos = road_offsets_[from->id], end = road_offsets_[from->id + 1]; pos < end; ++pos) {
+        if(road_neighbours_[pos].stop_id == to->id) {
+            return road_neighbours_[pos].distance;
+        }
+    }
+    //DEBUG
+    //CERR_ERROR << " ERROR: No stop distance found for stops [" << from->name << "] & [" << to->name << "]" << std::endl;
+    return std::numeric_limits<int>::max();
 }
 
 BusSet TransportDb::GetBusesForStop(std::string_view stop_name) const {
@@ -173,26 +268,16 @@ BusSet TransportDb::GetBusesForStop(std::string_view stop_name) const {
     return answer;
 }
 
-vector<StopPtr> TransportDb::GetStopPtrs(const vector<string_view>& bus_stops) const {
-    vector<StopPtr> ptr_vector;
-    for(const auto& stop : bus_stops) {
-        ptr_vector.push_back(stop_index_.at(stop));
-    }
-    return ptr_vector;
+std::string_view TransportDb::AddName(std::string_view name) {
+    char* data = static_cast<char*>(string_pool_.allocate(name.size(), alignof(char)));
+    std::copy(name.begin(), name.end(), data);
+    return {data, name.size()};
 }
 
-void TransportDb::ClearData() {
-    for(auto& [_, stop] : stop_index_) {
-        delete stop;
+std::span<const StopPtr> TransportDb::AddStopPtrs(const vector<string_view>& bus_stops) {
+    StopPtr* stops = std::pmr::polymorphic_allocator<>(&arena_).allocate_object<StopPtr>(bus_stops.size());
+    for(size_t i = 0; i < bus_stops.size(); ++i) {
+        stops[i] = stop_index_.at(bus_stops[i]);
     }
-    
-    for(auto& [_, bus] : bus_index_) {
-        delete bus;
-    }
-}
-
-size_t TransportDb::SPHasher::operator()(const StopPair& ptr_pair) const {
-    size_t n = 37;
-    std::hash<StopPtr> ptr_hash;
-    return n*ptr_hash(ptr_pair.first) + ptr_hash(ptr_pair.second);
+    return {stops, bus_stops.size()};
 }
@@ -3,9 +3,12 @@
 #include "domain.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <list>
+#include <memory_resource>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -16,45 +19,100 @@
 //#include <iostream>
 //#include <iomanip>
 
+//Build phase: Add* / SetRoadDistance, then Finalize(). Read phase: const methods only,
+//they never write -> safe for any number of concurrent readers without locks
 class TransportDb {
 public:
-    ~TransportDb() {
-        ClearData();
+    //names are copied into the string pool
+    StopPtr AddStop(std::string_view stop_name, geo::Coord coords);
+    BusPtr AddBus(std::string_view bus_name, const std::vector<std::string_view>& stops, bool is_roundtrip, std::string_view final_stop = {});
+    //the last distance set for a pair wins, takes effect with Finalize()
+    void SetRoadDistance(std::string_view from_stop_name, std::string_view to_stop_name, int dist);
+    //Call after loading, before queries: packs road distances into per-stop adjacency,
+    //a distance given in one direction only is used for both, and computes the stats of all buses
+    //on thread_count threads (0 -> one per core). Any Add* / SetRoadDistance afterwards needs another Finalize()
+    void Finalize(size_t thread_count = 1);
+    bool IsFinalized() const {
+        return is_finalized_;
     }
-    StopPtr AddStop(std::string stop_name, geo::Coord coords);
-    BusPtr AddBus(std::string bus_name, const std::vector<std::string_view>& stops, bool is_roundtrip, std::string_view final_stop = {});
-    //NB: Using const function which alters a mutable object, to be able to call in GetRoadDistance const
-    void SetRoadDistance(std::string_view from_stop_name, std::string_view to_stop_name, int dist) const;
     
+    //computed on every call, no cache
     double GetGeoDistance(StopPtr from, StopPtr to) const;
+    //Finalized database only, INT_MAX if not given in either direction
     int GetRoadDistance(StopPtr from, StopPtr to) const;
     
+    //Finalized database only, precomputed: segment i is stops[i] -> stops[i + 1]
+    std::span<const double> GetSegmentGeoLengths(BusPtr bus) const;
+    //Finalized database only, precomputed
     BusStat GetBusStat(std::string_view bus_name) const;
     StopStat GetStopStat(std::string_view stop_name) const;
     
     BusSet  GetAllBusesWithStops() const;
     StopSet GetAllStopsWithBuses() const;
+    
+    //changes with every added stop, bus or road distance -> data derived from the database is stale
+    size_t GetRevision() const {
+        return revision_;
+    }
+    size_t GetStopCount() const {
+        return stops_.size();
+    }
+    size_t GetBusCount() const {
+        return buses_.size();
+    }
 //    size_t GetNumBusesWithStops() const;
     
 private:
-    using StopPair = std::pair<StopPtr, StopPtr>;
+    struct RoadDistance {
+        uint32_t from = 0;
+        uint32_t to = 0;
+        int distance = 0;
+    };
+    struct RoadNeighbour {
+        uint32_t stop_id = 0;
+        int distance = 0;
+    };
+    
+    static constexpr size_t ARENA_INITIAL_BYTES = 64 * 1024;
+    static constexpr size_t STRING_POOL_INITIAL_BYTES = 16 * 1024;
     
     void AddBusToStops(BusPtr bus);
+    std::string_view AddName(std::string_view name);
+    //stop list of a bus, allocated in the arena
+    std::span<const StopPtr> AddStopPtrs(const std::vector<std::string_view>& bus_stops);
     
-    std::unordered_set<StopPtr> GetUniqueStops(BusPtr) const;
+    void FinalizeRoadDistances();
+    //GetRoadDistance without the finalized check, for Finalize() itself
+    int FindRoadDistance(StopPtr from, StopPtr to) const;
+    BusStat ComputeBusStat(BusPtr bus) const;
     BusSet GetBusesForStop(std::string_view stop_name) const;
-    std::vector<StopPtr> GetStopPtrs(const std::vector<std::string_view>& bus_stops) const;
     
-    void ClearData();
+    //Stops, buses & stop lists: bump-allocated in growing blocks, addresses are stable,
+    //everything is released at once by the destructor (no per-object deletes)
+    std::pmr::monotonic_buffer_resource arena_{ARENA_INITIAL_BYTES};
+    //names of all stops & buses, back to back
+    std::pmr::monotonic_buffer_resource string_pool_{STRING_POOL_INITIAL_BYTES};
     
-    std::unordered_map<std::string_view, Stop*> stop_index_;
-    std::unordered_map<std::string_view, Bus*> bus_index_;
-    std::unordered_map<std::string_view, std::unordered_set<std::string_view>> stops_to_buses_;
+    //indexes allocate their nodes in arena_ too -> declared after it
+    std::pmr::unordered_map<std::string_view, Stop*> stop_index_{&arena_};
+    std::pmr::unordered_map<std::string_view, Bus*> bus_index_{&arena_};
+    std::pmr::unordered_map<std::string_view, std::pmr::unordered_set<std::string_view>> stops_to_buses_{&arena_};
     
-    struct SPHasher {
-        size_t operator()(const StopPair& ptr_pair) const;
-    };
-    //can be modified by const member functions (e.g.GetStats)
-    mutable std::unordered_map<StopPair, double, SPHasher> geo_distance_table_;
-    mutable std::unordered_map<StopPair, int, SPHasher> road_distance_table_;
+    //by id
+    std::vector<Stop*> stops_;
+    std::vector<Bus*> buses_;
+    
+    //SetRoadDistance calls in order, kept for the next Finalize()
+    std::vector<RoadDistance> road_distances_set_;
+    //compressed sparse rows: neighbours of stop id are [road_offsets_[id], road_offsets_[id + 1])
+    //of road_neighbours_, sorted by neighbour id, reverse fallbacks included
+    std::vector<uint32_t> road_offsets_;
+    std::vector<RoadNeighbour> road_neighbours_;
+    //geo lengths of all bus segments, bus by bus: those of bus id start at segment_offsets_[id]
+    std::vector<size_t> segment_offsets_;
+    std::vector<double> segment_geo_lengths_;
+    //by bus id
+    std::vector<BusStat> bus_stats_;
+    bool is_finalized_ = false;
+    size_t revision_ = 0;
 };
@@ -1,85 +1,559 @@
 #include "transport_router.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
 #include <ranges>
+#include <tuple>
 using namespace std::literals;
  
 BusRouter::BusRouter(const TransportDb& tdb, BusRouterSettings settings)
 : settings_(std::move(settings))
 , tdb_(tdb)
-, bus_graph_(InitGraphFromDb())
-, graph_router_(std::make_unique<Router>(bus_graph_)) {
+, tree_cache_(settings_.tree_cache_bytes)
+, route_cache_(settings_.route_cache_bytes, settings_.route_cache_entries) {
 }
 
-RouteStat BusRouter::PlotRoute(std::string_view from, std::string_view to) const {
-    if(!graph_router_) {
-        throw std::runtime_error("BusRouter not initialized!");
+RouteStat BusRouter::PlotRoute(std::string_view from, std::string_view to) {
+    EnsureBuilt();
+    if(raptor_router_) {
+        return raptor_router_->PlotRoute(from, to);
     }
     if(stop_ids_.count(from) == 0 || stop_ids_.count(to) == 0) {
         CERR << "*Warning: Router cannot find stop [" << (stop_ids_.count(from) == 0 ? from : to) << "]\n";
         return {};
     }
-    auto route_info = graph_router_->BuildRoute(stop_ids_.at(from), stop_ids_.at(to));
-    return BuildRouteStat(route_info);
+    const auto from_id = stop_ids_.at(from);
+    const auto to_id = stop_ids_.at(to);
+    return PlotCachedRoute(from_id, to_id, [&]() {
+        return BuildRoute(from_id, to_id);
+    });
+}
+
+std::vector<RouteStat> BusRouter::PlotRoutes(std::string_view from, const std::vector<std::string_view>& to_stops) {
+    EnsureBuilt();
+    if(raptor_router_) {
+        return raptor_router_->PlotRoutes(from, to_stops);
+    }
+    std::vector<RouteStat> stats;
+    stats.reserve(to_stops.size());
+    //table lookups are as cheap as tree lookups, a single route is cheaper to search on its own
+    if(!dijkstra_router_ || to_stops.size() == 1 || stop_ids_.count(from) == 0) {
+        for(const auto to : to_stops) {
+            stats.push_back(PlotRoute(from, to));
+        }
+        return stats;
+    }
+    const auto from_id = stop_ids_.at(from);
+    //no search at all if every route is cached
+    std::shared_ptr<const ShortestPathTree> tree;
+    for(const auto to : to_stops) {
+        if(stop_ids_.count(to) == 0) {
+            CERR << "*Warning: Router cannot find stop [" << to << "]\n";
+            stats.push_back({});
+            continue;
+        }
+        const auto to_id = stop_ids_.at(to);
+        stats.push_back(PlotCachedRoute(from_id, to_id, [&]() {
+            if(!tree) {
+                tree = GetTree(from_id);
+            }
+            return dijkstra_router_->BuildRoute(*tree, to_id);
+        }));
+    }
+    return stats;
+}
+
+std::vector<RouteStat> BusRouter::PlotParetoRoutes(std::string_view from, std::string_view to) {
+    EnsureBuilt();
+    if(!raptor_router_) {
+        throw std::logic_error("BusRouter::PlotParetoRoutes: only the raptor engine keeps routes by bus count");
+    }
+    return raptor_router_->PlotParetoRoutes(from, to);
+}
+
+MatrixStat BusRouter::PlotMatrix(const std::vector<std::string_view>& sources,
+                                 const std::vector<std::string_view>& targets) {
+    EnsureBuilt();
+    MatrixStat stat;
+    stat.exists = true;
+    stat.source_count = sources.size();
+    stat.target_count = targets.size();
+    stat.times.resize(sources.size() * targets.size());
+    
+    auto find_vertex = [this](std::string_view stop) -> std::optional<graph::VertexId> {
+        const auto it = stop_ids_.find(stop);
+        if(it == stop_ids_.end()) {
+            CERR << "*Warning: Router cannot find stop [" << stop << "]\n";
+            return std::nullopt;
+        }
+        return it->second;
+    };
+    std::vector<std::optional<graph::VertexId>> target_ids;
+    if(!raptor_router_) {
+        target_ids.reserve(targets.size());
+        for(const auto to : targets) {
+            target_ids.push_back(find_vertex(to));
+        }
+    }
+    
+    //each task fills only the row of its source
+    auto fill_row = [&](size_t i) {
+        std::optional<double>* row = stat.times.data() + i * targets.size();
+        if(raptor_router_) {
+            const auto routes = raptor_router_->PlotRoutes(sources[i], targets);
+            for(size_t j = 0; j < targets.size(); ++j) {
+                if(routes[j].exists) {
+                    row[j] = routes[j].total_time;
+                }
+            }
+            return;
+        }
+        const auto from = find_vertex(sources[i]);
+        if(!from) {
+            return;
+        }
+        if(graph_router_) {
+            for(size_t j = 0; j < targets.size(); ++j) {
+                if(!target_ids[j]) {
+                    continue;
+                }
+                if(const auto weight = graph_router_->GetRouteWeight(*from, *target_ids[j])) {
+                    row[j] = ToMinutes(*weight);
+                }
+            }
+            return;
+        }
+        //one tree per source, trees of the matrix are not cached: they would evict the hot ones
+        const auto tree = dijkstra_router_->BuildTree(*from);
+        for(size_t j = 0; j < targets.size(); ++j) {
+            if(target_ids[j] && tree.weights[*target_ids[j]] != DijkstraRouter::UNREACHABLE) {
+                row[j] = ToMinutes(tree.weights[*target_ids[j]]);
+            }
+        }
+    };
+    //all_pairs rows are table lookups, cheaper than handing them to other threads
+    if(graph_router_ || !matrix_pool_) {
+        for(size_t i = 0; i < sources.size(); ++i) {
+            fill_row(i);
+        }
+    } else {
+        matrix_pool_->ParallelFor(sources.size(), fill_row);
+    }
+    return stat;
+}
+
+ReachableStat BusRouter::PlotReachable(std::string_view from, double max_time) {
+    EnsureBuilt();
+    ReachableStat stat;
+    if(raptor_router_) {
+        auto reachable = raptor_router_->FindReachable(from, max_time);
+        if(!reachable) {
+            return {};
+        }
+        stat.stops = std::move(*reachable);
+    } else {
+        if(stop_ids_.count(from) == 0) {
+            CERR << "*Warning: Router cannot find stop [" << from << "]\n";
+            return {};
+        }
+        const auto from_id = stop_ids_.at(from);
+        const Weight max_weight = ToWeight(max_time);
+        if(graph_router_) {
+            for(const auto& [name, vertex] : stop_ids_) {
+                const auto weight = graph_router_->GetRouteWeight(from_id, vertex);
+                if(weight && *weight <= max_weight) {
+                    stat.stops.push_back({name, ToMinutes(*weight)});
+                }
+            }
+        } else {
+            const auto tree = dijkstra_router_->BuildTree(from_id, max_weight);
+            for(const auto& [name, vertex] : stop_ids_) {
+                if(tree.weights[vertex] != DijkstraRouter::UNREACHABLE) {
+                    stat.stops.push_back({name, ToMinutes(tree.weights[vertex])});
+                }
+            }
+        }
+    }
+    stat.exists = true;
+    std::sort(stat.stops.begin(), stat.stops.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+        return std::tie(lhs.time, lhs.name) < std::tie(rhs.time, rhs.name);
+    });
+    return stat;
+}
+
+void BusRouter::UpdSettings(BusRouterSettings settings) {
+    Rebuild rebuild = Rebuild::none;
+    const bool was_raptor = settings_.router_type == RouterType::raptor;
+    const bool is_raptor = settings.router_type == RouterType::raptor;
+    if(settings.graph_model != settings_.graph_model || was_raptor != is_raptor) {
+        rebuild = Rebuild::full;
+    } else if(settings.wait_time != settings_.wait_time || settings.velocity_kmh != settings_.velocity_kmh) {
+        //same edges, other weights
+        rebuild = Rebuild::weights;
+    } else if(settings.router_type != settings_.router_type || settings.router_threads != settings_.router_threads
+              || settings.landmark_count != settings_.landmark_count) {
+        rebuild = Rebuild::router;
+    }
+    std::lock_guard lock(build_mutex_);
+    settings_ = std::move(settings);
+    tree_cache_.SetMaxBytes(settings_.tree_cache_bytes);
+    route_cache_.SetLimits(settings_.route_cache_bytes, settings_.route_cache_entries);
+    //a pending bigger rebuild stays
+    rebuild_ = std::max(rebuild_.load(), rebuild);
+}
+
+void BusRouter::Build() {
+    EnsureBuilt();
+}
+
+bool BusRouter::IsStale() const {
+    return rebuild_ != Rebuild::none || built_revision_ != tdb_.GetRevision();
 }
 
-graph::VertexId BusRouter::FindOrAddStopVertex(std::string_view stop_name) {
+void BusRouter::EnsureBuilt() {
+    if(!IsStale()) {
+        return;
+    }
+    std::lock_guard lock(build_mutex_);
+    //built by another thread while waiting
+    if(!IsStale()) {
+        return;
+    }
+    const Rebuild rebuild = rebuild_;
+    //a loaded file has no distances to reweight from nor stop locations for A*
+    if(built_revision_ != tdb_.GetRevision() || rebuild == Rebuild::full || mapped_file_) {
+        InitFromDb();
+    } else if(rebuild == Rebuild::weights) {
+        ReweightGraph();
+        InitRouter();
+    } else {
+        InitRouter();
+    }
+    built_revision_ = tdb_.GetRevision();
+    rebuild_ = Rebuild::none;
+}
+
+void BusRouter::InitFromDb() {
+    //routers refer to the graph -> reset first
+    graph_router_.reset();
+    dijkstra_router_.reset();
+    ch_router_.reset();
+    astar_router_.reset();
+    landmarks_.reset();
+    raptor_router_.reset();
+    stop_ids_.clear();
+    edge_data_.clear();
+    vertex_locations_.clear();
+    
+    //raptor scans the buses directly
+    bus_graph_ = settings_.router_type == RouterType::raptor ? Graph{} : InitGraphFromDb();
+    bus_graph_.Freeze();
+    mapped_file_.reset();
+    InitRouter();
+}
+
+void BusRouter::InitRouter() {
+    graph_router_.reset();
+    dijkstra_router_.reset();
+    ch_router_.reset();
+    astar_router_.reset();
+    landmarks_.reset();
+    raptor_router_.reset();
+    matrix_pool_.reset();
+    tree_cache_.Clear();
+    route_cache_.Clear();
+    
+    if(settings_.router_type != RouterType::all_pairs) {
+        matrix_pool_ = std::make_unique<ThreadPool>(settings_.router_threads);
+    }
+    switch (settings_.router_type) {
+        case RouterType::all_pairs:
+            graph_router_ = std::make_unique<Router>(bus_graph_, settings_.router_threads);
+            break;
+            
+        case RouterType::dijkstra:
+            dijkstra_router_ = std::make_unique<DijkstraRouter>(bus_graph_);
+            break;
+            
+        case RouterType::contraction_hierarchy:
+            ch_router_ = std::make_unique<ContractionHierarchy>(bus_graph_);
+            dijkstra_router_ = std::make_unique<DijkstraRouter>(bus_graph_);
+            break;
+            
+        case RouterType::astar:
+            road_to_geo_ratio_ = ComputeRoadToGeoRatio();
+            astar_router_ = std::make_unique<AStarRouter>(bus_graph_);
+            dijkstra_router_ = std::make_unique<DijkstraRouter>(bus_graph_);
+            break;
+            
+        case RouterType::alt:
+            landmarks_ = std::make_unique<Landmarks>(bus_graph_, settings_.landmark_count);
+            astar_router_ = std::make_unique<AStarRouter>(bus_graph_);
+            dijkstra_router_ = std::make_unique<DijkstraRouter>(bus_graph_);
+            break;
+            
+        case RouterType::raptor:
+            raptor_router_ = std::make_unique<RaptorRouter>(tdb_, settings_.wait_time, [this](StopPtr from, StopPtr to) {
+                return GetTravelTime(from, to);
+            });
+            break;
+    }
+}
+
+std::optional<BusRouter::RouteInfo> BusRouter::BuildRoute(graph::VertexId from, graph::VertexId to) const {
+    switch (settings_.router_type) {
+        case RouterType::all_pairs:
+            return graph_router_->BuildRoute(from, to);
+            
+        case RouterType::dijkstra:
+            if(settings_.tree_cache_bytes == 0) {
+                return dijkstra_router_->BuildRoute(from, to);
+            }
+            return dijkstra_router_->BuildRoute(*GetTree(from), to);
+            
+        case RouterType::contraction_hierarchy:
+            return ch_router_->BuildRoute(from, to);
+            
+        case RouterType::astar:
+            return astar_router_->BuildRoute(from, to, [this, to](graph::VertexId vertex) {
+                //integer weights are rounded down -> still a lower bound
+                return static_cast<Weight>(GetTravelTimeLowerBound(vertex, to) * WEIGHT_UNITS_IN_MINUTE);
+            });
+            
+        case RouterType::alt:
+            return astar_router_->BuildRoute(from, to, landmarks_->GetPotential(to));
+            
+        case RouterType::raptor:
+            //no graph, routes are built by raptor_router_ itself
+            break;
+    }
+    return std::nullopt;
+}
+
+//same weights as InitGraphFromDb gives for the current settings, edges are kept
+void BusRouter::ReweightGraph() {
+    std::vector<Weight> weights(bus_graph_.GetEdgeCount());
+    for(graph::EdgeId edge_id = 0; edge_id < weights.size(); ++edge_id) {
+        auto& info = edge_data_.at(edge_id);
+        switch (info.type) {
+            case EdgeType::span:
+                //dummy edge 0 of the stop_pairs model is a 0-span wait
+                info.time = GetTravelTime(info.distance);
+                weights[edge_id] = ToWeight(settings_.wait_time + info.time);
+                break;
+                
+            case EdgeType::board:
+                weights[edge_id] = ToWeight(settings_.wait_time);
+                break;
+                
+            case EdgeType::ride:
+                info.time = GetTravelTime(info.distance);
+                weights[edge_id] = GetRideWeight(info.chain_distance, info.distance);
+                break;
+                
+            case EdgeType::alight:
+                weights[edge_id] = ToWeight(0.0);
+                break;
+        }
+    }
+    bus_graph_.SetWeights(weights);
+}
+
+template <typename RouteBuilder>
+RouteStat BusRouter::PlotCachedRoute(graph::VertexId from, graph::VertexId to, RouteBuilder build_route) {
+    if(settings_.route_cache_bytes == 0) {
+        return BuildRouteStat(build_route());
+    }
+    if(const auto cached = route_cache_.Find({from, to})) {
+        return *cached;
+    }
+    auto stat = std::make_shared<const RouteStat>(BuildRouteStat(build_route()));
+    const size_t bytes = sizeof(RouteStat) + stat->items.size() * sizeof(RouteItem);
+    route_cache_.Insert({from, to}, stat, bytes);
+    return *stat;
+}
+
+std::shared_ptr<const BusRouter::ShortestPathTree> BusRouter::GetTree(graph::VertexId from) const {
+    if(settings_.tree_cache_bytes == 0) {
+        return std::make_shared<const ShortestPathTree>(dijkstra_router_->BuildTree(from));
+    }
+    auto tree = tree_cache_.Find(from);
+    if(!tree) {
+        tree = std::make_shared<const ShortestPathTree>(dijkstra_router_->BuildTree(from));
+        tree_cache_.Insert(from, tree, tree->GetSizeBytes());
+    }
+    return tree;
+}
+
+graph::VertexId BusRouter::FindOrAddStopVertex(StopPtr stop) {
     //Inserts new value or returns id of existing entry; pair<it,bool>->pair<name, VertexId>;
-    return (stop_ids_.insert( {stop_name, stop_ids_.size()} )).first->second;
+    const auto [it, inserted] = stop_ids_.insert( {stop->name, stop_ids_.size()} );
+    if(inserted) {
+        SetVertexLocation(it->second, stop->location);
+    }
+    return it->second;
 }
 
-void BusRouter::AddStopsToGraph(BusPtr bus, StopPtr from_stop, auto stops_range) {
-    auto from_id = FindOrAddStopVertex(from_stop->name);
+void BusRouter::SetVertexLocation(graph::VertexId vertex, geo::Coord location) {
+    if(vertex >= vertex_locations_.size()) {
+        vertex_locations_.resize(vertex + 1);
+    }
+    vertex_locations_[vertex] = geo::ToEarthPoint(location);
+}
+
+void BusRouter::AddStopsToGraph(Graph& bus_graph, BusPtr bus, StopPtr from_stop, auto stops_range) {
+    auto from_id = FindOrAddStopVertex(from_stop);
     StopPtr prev_stop = from_stop;
     
-    bool stops_are_adjacent = true;
+    //edge 0 is a 0-span dummy -> first span starts from it
     size_t prev_edge = 0;
     
     //Iterate though all remaining stops -> start at stop which is after from_stop
     for(const auto& to_stop : stops_range) {
-        //Additional travel time from this stop to next
-        double add_travel_time = 1.0 * tdb_.GetRoadDistance(prev_stop, to_stop)
-        / settings_.velocity_kmh * METERS_IN_KM / MINUTES_IN_HOUR;
-        
-        //Get previous edge travel time from graph,
-        double edge_weight //if(stops_are_adjacent) -> gives bus wait time
-        = bus_graph_.GetEdge(stops_are_adjacent ? 0 : prev_edge).weight
-        + add_travel_time;
-        
         int spans = edge_data_.at(prev_edge).span_count + 1;
+        //weights are computed from distances, so ReweightGraph gives the same ones
+        double distance = edge_data_.at(prev_edge).distance + tdb_.GetRoadDistance(prev_stop, to_stop);
+        //riding time only, without the wait at from_stop
+        double ride_time = GetTravelTime(distance);
         
-        prev_edge = bus_graph_.AddEdge({
+        prev_edge = bus_graph.AddEdge({
             //starting vertex, graph::VertexId
             from_id,
             //destination vertex, graph::VertexId
-            FindOrAddStopVertex(to_stop->name),
-            //total time taken, double
-            edge_weight
+            FindOrAddStopVertex(to_stop),
+            //total time taken
+            ToWeight(settings_.wait_time + ride_time)
         });
         
         //Store info for building Item Array (in request response)
         edge_data_.push_back({
-            bus,
+            EdgeType::span,
+            bus->name,
             spans,
-            add_travel_time,
+            ride_time,
             from_stop->name,
-            to_stop->name
+            to_stop->name,
+            distance
         });
-        stops_are_adjacent = false;
         prev_stop = to_stop;
     }
 }
 
+void BusRouter::AddBusChainToGraph(Graph& bus_graph, BusPtr bus, graph::VertexId first_vertex, auto stops_range) {
+    const graph::VertexId last_vertex = first_vertex + std::ranges::distance(stops_range) - 1;
+    graph::VertexId on_bus_vertex = first_vertex;
+    StopPtr prev_stop = nullptr;
+    double chain_distance = 0.0;
+    
+    for(const auto& stop : stops_range) {
+        const auto stop_vertex = FindOrAddStopVertex(stop);
+        SetVertexLocation(on_bus_vertex, stop->location);
+        if(prev_stop) {
+            //ride one span from the previous "on bus" vertex, then it is possible to get off
+            const double distance = tdb_.GetRoadDistance(prev_stop, stop);
+            const double ride_time = GetTravelTime(distance);
+            chain_distance += distance;
+            bus_graph.AddEdge({on_bus_vertex - 1, on_bus_vertex, GetRideWeight(chain_distance, distance)});
+            edge_data_.push_back({EdgeType::ride, bus->name, 1, ride_time, prev_stop->name, stop->name, distance, chain_distance});
+            
+            bus_graph.AddEdge({on_bus_vertex, stop_vertex, ToWeight(0.0)});
+            edge_data_.push_back({EdgeType::alight, bus->name, 0, 0.0, stop->name, stop->name});
+        }
+        //get on, except at the last stop of the chain (cannot ride any further)
+        if(on_bus_vertex != last_vertex) {
+            bus_graph.AddEdge({stop_vertex, on_bus_vertex, ToWeight(settings_.wait_time)});
+            edge_data_.push_back({EdgeType::board, bus->name, 0, 0.0, stop->name, stop->name});
+        }
+        prev_stop = stop;
+        ++on_bus_vertex;
+    }
+}
+
+BusRouter::Weight BusRouter::ToWeight(double minutes) {
+    if constexpr (std::is_integral_v<Weight>) {
+        const double units = std::round(minutes * WEIGHT_UNITS_IN_MINUTE);
+        const double max_units = graph::WeightTraits<Weight>::UNREACHABLE - 1.0;
+        return static_cast<Weight>(std::clamp(units, 0.0, max_units));
+    } else {
+        return minutes;
+    }
+}
+
+//Integer weights: rounding every span separately adds up along a ride. Differences of rounded times
+//from the chain start telescope -> a ride of any length is off by half a unit at most
+BusRouter::Weight BusRouter::GetRideWeight(double chain_distance, double distance) const {
+    if constexpr (std::is_integral_v<Weight>) {
+        return ToWeight(GetTravelTime(chain_distance)) - ToWeight(GetTravelTime(chain_distance - distance));
+    } else {
+        return ToWeight(GetTravelTime(distance));
+    }
+}
+
+double BusRouter::ToMinutes(Weight weight) {
+    return weight / WEIGHT_UNITS_IN_MINUTE;
+}
+
+double BusRouter::GetTravelTime(StopPtr from, StopPtr to) const {
+    return GetTravelTime(1.0 * tdb_.GetRoadDistance(from, to));
+}
+
+//distance in meters -> minutes
+double BusRouter::GetTravelTime(double distance) const {
+    return distance / (settings_.velocity_kmh * METERS_IN_KM / MINUTES_IN_HOUR);
+}
+
+//Road distances may be given shorter than the straight line between stop coordinates,
+//scaling geo distances by the smallest ratio keeps them a lower bound of any route
+double BusRouter::ComputeRoadToGeoRatio() const {
+    double ratio = 1.0;
+    for(const auto& bus : tdb_.GetAllBusesWithStops()) {
+        const auto geo_lengths = tdb_.GetSegmentGeoLengths(bus);
+        for(size_t i = 1; i < bus->stops.size(); ++i) {
+            const double geo_distance = geo_lengths[i - 1];
+            if(geo_distance > 0) {
+                ratio = std::min(ratio, tdb_.GetRoadDistance(bus->stops[i - 1], bus->stops[i]) / geo_distance);
+            }
+        }
+    }
+    return ratio;
+}
+
+double BusRouter::GetTravelTimeLowerBound(graph::VertexId vertex, graph::VertexId target) const {
+    if(vertex == target) {
+        return 0.0;
+    }
+    //chord is shorter than the geo distance, cheap enough to be computed for every queued vertex
+    const double distance = geo::ComputeChordDistance(vertex_locations_[vertex], vertex_locations_[target]);
+    const double ride_time = GetTravelTime(distance * road_to_geo_ratio_ * HEURISTIC_MARGIN);
+    //stop vertices go first in both models, leaving a stop other than the target takes a bus -> a wait
+    return vertex < stop_ids_.size() ? settings_.wait_time + ride_time : ride_time;
+}
+
 //writes stop ids into map during graph building
 BusRouter::Graph BusRouter::InitGraphFromDb() {
+    switch (settings_.graph_model) {
+        case GraphModel::linear:
+            return InitLinearGraph();
+            
+        case GraphModel::stop_pairs:
+        default:
+            return InitStopPairsGraph();
+    }
+}
+
+BusRouter::Graph BusRouter::InitStopPairsGraph() {
     //1.Get buses -> set<BusPtr>, init Graph;
     BusSet buses = tdb_.GetAllBusesWithStops();
-    Graph bus_graph(buses.size());
+    //one vertex per stop served by at least one bus
+    Graph bus_graph(tdb_.GetAllStopsWithBuses().size());
     if(buses.size() == 0) {
         return {};
     }
     
     //1.1.Add waiting time edge
-    bus_graph.AddEdge({0, 0, 1.0 * settings_.wait_time});
+    bus_graph.AddEdge({0, 0, ToWeight(settings_.wait_time)});
     //1.2.Init Edge Data with a 0-span Info for EdgeId 0
     edge_data_.push_back({});
     
@@ -92,13 +566,13 @@ BusRouter::Graph BusRouter::InitGraphFromDb() {
         //2.1.Iterate through all stops, until final stop is reached (middle of vector for !is_roundtrip buses)
         for(const auto& from_stop : bus->stops | std::views::take(no_repeats)) {
             // 0 1 2 3 2 1 0 -> take first half, 0 1 2 3, drop passed stops, e.g. from 1 -> range is: 2, 3;
-            AddStopsToGraph(bus, from_stop, bus->stops
+            AddStopsToGraph(bus_graph, bus, from_stop, bus->stops
                             | std::views::take(no_repeats)
                             | std::views::drop(processed_stops + 1));
             
             if(!bus->is_roundtrip) {
                 //add previous bus stops backwards if not roundtrip
-                AddStopsToGraph(bus, from_stop, bus->stops
+                AddStopsToGraph(bus_graph, bus, from_stop, bus->stops
                                 | std::views::take(processed_stops)
                                 | std::views::reverse);
             }
@@ -108,22 +582,324 @@ BusRouter::Graph BusRouter::InitGraphFromDb() {
     return bus_graph;
 }
 
+BusRouter::Graph BusRouter::InitLinearGraph() {
+    BusSet buses = tdb_.GetAllBusesWithStops();
+    if(buses.empty()) {
+        return {};
+    }
+    //1."at stop" vertices go first: [0, stop_count)
+    const size_t stop_count = tdb_.GetAllStopsWithBuses().size();
+    
+    //2."on bus" vertices: a chain per bus direction, same spans as in the stop_pairs model:
+    //roundtrip - whole route, otherwise - forward & backward halves (no riding through the final stop)
+    auto forward_stops = [](BusPtr bus) {
+        return bus->stops | std::views::take(bus->is_roundtrip ? bus->stops.size() : bus->stops.size() / 2 + 1);
+    };
+    size_t vertex_count = stop_count;
+    for(const auto& bus : buses) {
+        vertex_count += std::ranges::distance(forward_stops(bus)) * (bus->is_roundtrip ? 1 : 2);
+    }
+    
+    Graph bus_graph(vertex_count);
+    graph::VertexId next_vertex = stop_count;
+    for(const auto& bus : buses) {
+        const auto stops = forward_stops(bus);
+        AddBusChainToGraph(bus_graph, bus, next_vertex, stops);
+        next_vertex += std::ranges::distance(stops);
+        
+        if(!bus->is_roundtrip) {
+            AddBusChainToGraph(bus_graph, bus, next_vertex, stops | std::views::reverse);
+            next_vertex += std::ranges::distance(stops);
+        }
+    }
+    return bus_graph;
+}
+
 RouteStat BusRouter::BuildRouteStat(const std::optional<RouteInfo>& info) const {
     RouteStat stat;
     if(!info.has_value()) {
         return {};
     }
     stat.exists = true;
-    stat.total_time = info->weight;
+    stat.total_time = ToMinutes(info->weight);
     
     for(auto edge_id : info->edges) {
         if(edge_data_.size() <= edge_id) {
             continue;
         }
         const auto& edge_info = edge_data_.at(edge_id);
-        stat.items.push_back({RouteItemType::wait, edge_info.from, 1.0 * settings_.wait_time});
-        stat.items.push_back({RouteItemType::bus, edge_info.bus->name, edge_info.time, edge_info.span_count});
+        switch (edge_info.type) {
+            case EdgeType::span:
+                stat.items.push_back({RouteItemType::wait, edge_info.from, 1.0 * settings_.wait_time});
+                stat.items.push_back({RouteItemType::bus, edge_info.bus_name, edge_info.time, edge_info.span_count});
+                break;
+                
+            case EdgeType::board:
+                stat.items.push_back({RouteItemType::wait, edge_info.from, 1.0 * settings_.wait_time});
+                stat.items.push_back({RouteItemType::bus, edge_info.bus_name});
+                break;
+                
+            case EdgeType::ride:
+                //a route always boards before riding -> last item is this bus
+                stat.items.back().time_taken += edge_info.time;
+                stat.items.back().span_count += edge_info.span_count;
+                break;
+                
+            case EdgeType::alight:
+                break;
+        }
     }
     
+    //rounded integer weights only pick the route, its time is the exact sum of the items
+    if constexpr (std::is_integral_v<Weight>) {
+        stat.total_time = 0.0;
+        for(const auto& item : stat.items) {
+            stat.total_time += item.time_taken;
+        }
+    }
     return stat;
 }
+
+//================ Router file ================//
+namespace {
+
+//Layout: header, then sections at ALIGNMENT-aligned offsets:
+//edges, edge infos, stop names (index = vertex id), string pool, routes weights, routes prev edges
+constexpr char ROUTER_FILE_MAGIC[8] = {'T', 'C', 'R', 'O', 'U', 'T', 'E', 'R'};
+constexpr uint32_t ROUTER_FILE_VERSION = 2;
+constexpr uint64_t ALIGNMENT = 64;
+
+struct RouterFileHeader {
+    char magic[8] = {};
+    uint32_t version = 0;
+    uint32_t weight_size = 0;
+    int32_t wait_time = 0;
+    uint32_t reserved = 0;
+    double velocity_kmh = 0.0;
+    uint64_t vertex_count = 0;
+    uint64_t edge_count = 0;
+    uint64_t edges_offset = 0;
+    uint64_t edge_infos_offset = 0;
+    uint64_t stop_names_offset = 0;
+    uint64_t strings_offset = 0;
+    uint64_t strings_size = 0;
+    uint64_t route_weights_offset = 0;
+    uint64_t prev_edges_offset = 0;
+    uint64_t file_size = 0;
+};
+
+struct FileString {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+struct FileEdge {
+    uint64_t from = 0;
+    uint64_t to = 0;
+    //route weight of header.weight_size bytes, exact in a double for uint32 weights too
+    double weight = 0.0;
+};
+
+struct FileEdgeInfo {
+    FileString bus_name;
+    FileString from;
+    FileString to;
+    int32_t span_count = 0;
+    uint32_t type = 0;
+    double time = 0.0;
+};
+
+uint64_t AlignUp(uint64_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+//Collects unique strings into one pool
+class StringPool {
+public:
+    FileString Add(std::string_view str) {
+        auto [it, inserted] = offsets_.insert({str, pool_.size()});
+        if(inserted) {
+            pool_.append(str);
+        }
+        return {it->second, str.size()};
+    }
+    const std::string& GetPool() const {
+        return pool_;
+    }
+private:
+    std::string pool_;
+    std::unordered_map<std::string_view, uint64_t> offsets_;
+};
+
+void WritePadding(std::ostream& out, uint64_t offset) {
+    static const char zeros[ALIGNMENT] = {};
+    const uint64_t pos = static_cast<uint64_t>(out.tellp());
+    out.write(zeros, static_cast<std::streamsize>(offset - pos));
+}
+
+template <typename T>
+void WriteSection(std::ostream& out, uint64_t offset, const T* data, uint64_t count) {
+    WritePadding(out, offset);
+    out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+template <typename T>
+const T* GetSection(const MappedFile& file, uint64_t offset, uint64_t count) {
+    if(offset % alignof(T) != 0 || offset > file.GetSize() || count > (file.GetSize() - offset) / sizeof(T)) {
+        throw std::runtime_error("Router file: corrupted section");
+    }
+    return reinterpret_cast<const T*>(file.GetData() + offset);
+}
+
+}  // namespace
+
+void BusRouter::SaveToFile(const std::filesystem::path& file) {
+    EnsureBuilt();
+    if(!graph_router_) {
+        throw std::logic_error("BusRouter::SaveToFile: only the all_pairs routes table can be saved");
+    }
+    const uint64_t vertex_count = bus_graph_.GetVertexCount();
+    const uint64_t edge_count = bus_graph_.GetEdgeCount();
+    
+    StringPool strings;
+    std::vector<FileEdge> edges;
+    std::vector<FileEdgeInfo> edge_infos;
+    std::vector<FileString> stop_names(vertex_count);
+    
+    edges.reserve(edge_count);
+    edge_infos.reserve(edge_count);
+    for(graph::EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto& edge = bus_graph_.GetEdge(edge_id);
+        const auto& info = edge_data_.at(edge_id);
+        edges.push_back({edge.from, edge.to, static_cast<double>(edge.weight)});
+        edge_infos.push_back({strings.Add(info.bus_name), strings.Add(info.from), strings.Add(info.to),
+                              info.span_count, static_cast<uint32_t>(info.type), info.time});
+    }
+    for(const auto& [name, vertex_id] : stop_ids_) {
+        stop_names[vertex_id] = strings.Add(name);
+    }
+    
+    RouterFileHeader header;
+    std::copy(std::begin(ROUTER_FILE_MAGIC), std::end(ROUTER_FILE_MAGIC), header.magic);
+    header.version = ROUTER_FILE_VERSION;
+    header.weight_size = sizeof(Weight);
+    header.wait_time = settings_.wait_time;
+    header.velocity_kmh = settings_.velocity_kmh;
+    header.vertex_count = vertex_count;
+    header.edge_count = edge_count;
+    header.edges_offset = AlignUp(sizeof(RouterFileHeader));
+    header.edge_infos_offset = AlignUp(header.edges_offset + edge_count * sizeof(FileEdge));
+    header.stop_names_offset = AlignUp(header.edge_infos_offset + edge_count * sizeof(FileEdgeInfo));
+    header.strings_offset = AlignUp(header.stop_names_offset + vertex_count * sizeof(FileString));
+    header.strings_size = strings.GetPool().size();
+    header.route_weights_offset = AlignUp(header.strings_offset + header.strings_size);
+    header.prev_edges_offset = AlignUp(header.route_weights_offset + vertex_count * vertex_count * sizeof(Weight));
+    header.file_size = header.prev_edges_offset + vertex_count * vertex_count * sizeof(Router::PrevEdgeId);
+    
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if(!out) {
+        throw std::runtime_error("BusRouter::SaveToFile: cannot open "s + file.string());
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WriteSection(out, header.edges_offset, edges.data(), edge_count);
+    WriteSection(out, header.edge_infos_offset, edge_infos.data(), edge_count);
+    WriteSection(out, header.stop_names_offset, stop_names.data(), vertex_count);
+    WriteSection(out, header.strings_offset, strings.GetPool().data(), header.strings_size);
+    WriteSection(out, header.route_weights_offset, graph_router_->GetRouteWeights(), vertex_count * vertex_count);
+    WriteSection(out, header.prev_edges_offset, graph_router_->GetPrevEdges(), vertex_count * vertex_count);
+    if(!out) {
+        throw std::runtime_error("BusRouter::SaveToFile: write failed for "s + file.string());
+    }
+}
+
+void BusRouter::LoadFromFile(const std::filesystem::path& file) {
+    auto mapped_file = std::make_unique<MappedFile>(file);
+    
+    RouterFileHeader header;
+    if(mapped_file->GetSize() < sizeof(header)) {
+        throw std::runtime_error("Router file: too small");
+    }
+    std::copy_n(mapped_file->GetData(), sizeof(header), reinterpret_cast<char*>(&header));
+    if(!std::equal(std::begin(ROUTER_FILE_MAGIC), std::end(ROUTER_FILE_MAGIC), header.magic)
+       || header.version != ROUTER_FILE_VERSION
+       || header.weight_size != sizeof(Weight)
+       || header.file_size != mapped_file->GetSize()) {
+        throw std::runtime_error("Router file: unsupported format or version");
+    }
+    if(header.vertex_count > std::numeric_limits<uint32_t>::max()
+       || header.edge_count >= Router::NO_EDGE) {
+        throw std::runtime_error("Router file: corrupted header");
+    }
+    //< 2^64, no overflow. Cells are checked when read (Router::BuildRoute), a check here
+    //would read every page of the table at startup
+    const uint64_t cell_count = header.vertex_count * header.vertex_count;
+    const auto* edges = GetSection<FileEdge>(*mapped_file, header.edges_offset, header.edge_count);
+    const auto* edge_infos = GetSection<FileEdgeInfo>(*mapped_file, header.edge_infos_offset, header.edge_count);
+    const auto* stop_names = GetSection<FileString>(*mapped_file, header.stop_names_offset, header.vertex_count);
+    const auto* strings = GetSection<char>(*mapped_file, header.strings_offset, header.strings_size);
+    const auto* route_weights = GetSection<Weight>(*mapped_file, header.route_weights_offset, cell_count);
+    const auto* prev_edges = GetSection<Router::PrevEdgeId>(*mapped_file, header.prev_edges_offset, cell_count);
+    
+    auto to_string_view = [&](const FileString& str) {
+        if(str.offset > header.strings_size || str.size > header.strings_size - str.offset) {
+            throw std::runtime_error("Router file: corrupted string");
+        }
+        return std::string_view(strings + str.offset, str.size);
+    };
+    
+    //parse everything first, the current router stays intact if the file is corrupted
+    Graph bus_graph(header.vertex_count);
+    std::vector<EdgeInfo> edge_data;
+    StopIdMap stop_ids;
+    edge_data.reserve(header.edge_count);
+    for(uint64_t edge_id = 0; edge_id < header.edge_count; ++edge_id) {
+        if(edges[edge_id].from >= header.vertex_count || edges[edge_id].to >= header.vertex_count) {
+            throw std::runtime_error("Router file: corrupted edge");
+        }
+        bus_graph.AddEdge({edges[edge_id].from, edges[edge_id].to, static_cast<Weight>(edges[edge_id].weight)});
+        const auto& info = edge_infos[edge_id];
+        if(info.type > static_cast<uint32_t>(EdgeType::alight)) {
+            throw std::runtime_error("Router file: corrupted edge info");
+        }
+        edge_data.push_back({
+            static_cast<EdgeType>(info.type),
+            to_string_view(info.bus_name),
+            static_cast<int>(info.span_count),
+            info.time,
+            to_string_view(info.from),
+            to_string_view(info.to)
+        });
+    }
+    for(graph::VertexId vertex_id = 0; vertex_id < header.vertex_count; ++vertex_id) {
+        //"on bus" vertices of the linear model have no name
+        if(stop_names[vertex_id].size > 0) {
+            stop_ids[to_string_view(stop_names[vertex_id])] = vertex_id;
+        }
+    }
+    bus_graph.Freeze();
+    
+    //routers refer to the graph -> reset first
+    graph_router_.reset();
+    dijkstra_router_.reset();
+    ch_router_.reset();
+    astar_router_.reset();
+    landmarks_.reset();
+    raptor_router_.reset();
+    matrix_pool_.reset();
+    tree_cache_.Clear();
+    route_cache_.Clear();
+    bus_graph_ = std::move(bus_graph);
+    edge_data_ = std::move(edge_data);
+    stop_ids_ = std::move(stop_ids);
+    //not in the file, ids of another graph
+    vertex_locations_.clear();
+    
+    settings_.wait_time = header.wait_time;
+    settings_.velocity_kmh = header.velocity_kmh;
+    settings_.router_type = RouterType::all_pairs;
+    graph_router_ = std::make_unique<Router>(bus_graph_, route_weights, prev_edges);
+    mapped_file_ = std::move(mapped_file);
+    //the loaded router is up to date for the current db
+    built_revision_ = tdb_.GetRevision();
+    rebuild_ = Rebuild::none;
+}
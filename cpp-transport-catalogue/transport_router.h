@@ -1,56 +1,247 @@
 #pragma once
 
 #include "transport_catalogue.h"
+#include "astar_router.h"
+#include "contraction_hierarchy.h"
+#include "dijkstra_router.h"
 #include "graph.h"
+#include "landmarks.h"
+#include "lru_cache.h"
+#include "mapped_file.h"
+#include "raptor_router.h"
 #include "router.h"
+#include "thread_pool.h"
 
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <type_traits>
+
+//Route weights of the graph engines: 0 - double minutes, 1 - uint32 hundredths of a minute
+//(half the all_pairs table, saturating integer sums); answers are converted back to minutes.
+//Set by the TRANSPORT_CENTIMINUTE_WEIGHTS CMake option
+#ifndef TRANSPORT_CENTIMINUTE_WEIGHTS
+#define TRANSPORT_CENTIMINUTE_WEIGHTS 0
+#endif
+static constexpr bool CENTIMINUTE_WEIGHTS = TRANSPORT_CENTIMINUTE_WEIGHTS != 0;
+
+//all_pairs: precomputed Floyd-Warshall table, O(V^3) startup, O(route) queries
+//dijkstra: no precompute, one single-source search per query
+//contraction_hierarchy: vertex ordering & shortcuts at build time, bidirectional upward search per query
+//astar: no precompute, one search per query directed to the destination by straight-line distance
+//alt: route weights from & to a few landmarks at build time, O(landmarks * V) memory,
+//  one search per query directed to the destination by landmark lower bounds
+//raptor: no graph, rounds of bus scans over the stop sequences, one round per bus taken
+enum class RouterType {
+    all_pairs,
+    dijkstra,
+    contraction_hierarchy,
+    astar,
+    alt,
+    raptor,
+};
+
+//stop_pairs: one vertex per stop, one edge (wait + ride) from every stop to every later stop of a bus,
+//  O(n^2) edges for an n-stop bus
+//linear: "at stop" vertices & one "on bus" vertex per stop of a bus, with boarding (wait),
+//  riding (one span) and alighting (free) edges, O(n) edges & vertices for an n-stop bus
+enum class GraphModel {
+    stop_pairs,
+    linear,
+};
 
 struct BusRouterSettings {    
     int wait_time = 0;
     double velocity_kmh = 0;
+    RouterType router_type = RouterType::all_pairs;
+    GraphModel graph_model = GraphModel::stop_pairs;
+    //all_pairs precompute & PlotMatrix threads, 1 = serial, 0 = all cores
+    size_t router_threads = 1;
+    //memory budget for cached shortest-path trees of the dijkstra engine, 0 = no caching
+    size_t tree_cache_bytes = 64 * 1024 * 1024;
+    //finished routes by (from, to) of the graph engines, 0 bytes = no caching
+    size_t route_cache_bytes = 16 * 1024 * 1024;
+    size_t route_cache_entries = NO_ENTRY_LIMIT;
+    //landmarks of the alt engine, each one costs two full searches at build time
+    size_t landmark_count = 16;
 };
 
 class BusRouter {
-    using Graph = graph::DirectedWeightedGraph<double>;
-    using Router = graph::Router<double>;
-    using RouteInfo = graph::Router<double>::RouteInfo;
+public:
+    //route weights in minutes * WEIGHT_UNITS_IN_MINUTE
+    using Weight = std::conditional_t<CENTIMINUTE_WEIGHTS, uint32_t, double>;
+    using Graph = graph::DirectedWeightedGraph<Weight>;
+    static constexpr double WEIGHT_UNITS_IN_MINUTE = CENTIMINUTE_WEIGHTS ? 100.0 : 1.0;
+    
+private:
+    using Router = graph::Router<Weight>;
+    //queue_benchmark: the 4-ary heap matches or beats the binary one with the same results,
+    //the radix heap is ~2x faster on linear graphs (integer weights only)
+    using DijkstraQueue = std::conditional_t<CENTIMINUTE_WEIGHTS, graph::RadixHeap<Weight>, graph::QuaternaryHeap<Weight>>;
+    using DijkstraRouter = graph::DijkstraRouter<Weight, DijkstraQueue>;
+    using ContractionHierarchy = graph::ContractionHierarchy<Weight>;
+    using AStarRouter = graph::AStarRouter<Weight>;
+    using Landmarks = graph::Landmarks<Weight>;
+    using RouteInfo = graph::Router<Weight>::RouteInfo;
+    using ShortestPathTree = DijkstraRouter::ShortestPathTree;
     
 public:
+    //Graph & router are built lazily by the first query (or SaveToFile) and rebuilt by the next one,
+    //if the database or the settings have changed since; queries may run concurrently
     explicit BusRouter(const TransportDb& tdb, BusRouterSettings settings = {});
     
-    RouteStat PlotRoute(std::string_view from, std::string_view to) const;
+    RouteStat PlotRoute(std::string_view from, std::string_view to);
+    //Routes from one stop to many, in to_stops order: one single-source search
+    //for all of them, instead of one search per route (except for all_pairs)
+    std::vector<RouteStat> PlotRoutes(std::string_view from, const std::vector<std::string_view>& to_stops);
+    //Fastest route for every number of buses, if faster than with fewer buses; raptor only
+    std::vector<RouteStat> PlotParetoRoutes(std::string_view from, std::string_view to);
+    //Travel times only, from every source to every target: one single-source search per source,
+    //on one pool of router_threads threads shared by all calls (table lookups in the calling thread for all_pairs)
+    MatrixStat PlotMatrix(const std::vector<std::string_view>& sources, const std::vector<std::string_view>& targets);
+    //Stops reachable within max_time minutes: search stopped at max_time, no routes built
+    //(a table row for all_pairs)
+    ReachableStat PlotReachable(std::string_view from, double max_time);
+    
+    //Only marks what the next query has to rebuild: new wait_time / velocity_kmh reweight
+    //the edges of the existing graph, a new graph_model rebuilds the graph
+    void UpdSettings(BusRouterSettings settings);
+    //Builds what the next query would build, now (e.g. to keep it out of the first query latency)
+    void Build();
     
-    inline void UpdSettings(BusRouterSettings settings) {
-        settings_ = settings;
+    //Writes graph, all_pairs routes table & edge info into a versioned binary file
+    void SaveToFile(const std::filesystem::path& file);
+    //Replaces the router with one saved by SaveToFile, routes table is memory-mapped
+    //read-only, so processes loading the same file share its pages
+    void LoadFromFile(const std::filesystem::path& file);
+    
+    inline CacheStats GetTreeCacheStats() const {
+        return tree_cache_.GetStats();
+    }
+    inline CacheStats GetRouteCacheStats() const {
+        return route_cache_.GetStats();
+    }
+    //graph of the last build, empty for raptor
+    inline const Graph& GetGraph() const {
+        return bus_graph_;
     }
     
 private:
     static constexpr double METERS_IN_KM = 1000.0;
     static constexpr double MINUTES_IN_HOUR = 60.0;
+    //keeps the astar lower bound below the real travel time despite rounding of geo distances
+    static constexpr double HEURISTIC_MARGIN = 0.999;
+    static constexpr size_t NOT_BUILT = std::numeric_limits<size_t>::max();
+    
+    //what the next query has to rebuild, ordered by amount of work
+    enum class Rebuild {
+        none,
+        router,
+        weights,
+        full,
+    };
     
     BusRouterSettings settings_;
     const TransportDb& tdb_;
+    //database revision the graph was built from
+    std::atomic<size_t> built_revision_ = NOT_BUILT;
+    std::atomic<Rebuild> rebuild_ = Rebuild::full;
+    std::mutex build_mutex_;
     Graph bus_graph_;
+    //only the engine selected by settings_.router_type is constructed,
+    //dijkstra_router_ is also built for the searching engines -> builds trees for PlotRoutes
     std::unique_ptr<Router> graph_router_ = nullptr;
+    std::unique_ptr<DijkstraRouter> dijkstra_router_ = nullptr;
+    std::unique_ptr<ContractionHierarchy> ch_router_ = nullptr;
+    std::unique_ptr<AStarRouter> astar_router_ = nullptr;
+    //potentials of astar_router_ for the alt engine
+    std::unique_ptr<Landmarks> landmarks_ = nullptr;
+    //works on the database, bus_graph_ is left empty
+    std::unique_ptr<RaptorRouter> raptor_router_ = nullptr;
+    //PlotMatrix searches, concurrent calls take turns instead of starting threads of their own
+    std::unique_ptr<ThreadPool> matrix_pool_ = nullptr;
+    //per-source trees of dijkstra_router_, repeat queries from a source only rebuild the path
+    mutable LruCache<graph::VertexId, ShortestPathTree> tree_cache_;
+    
+    using VertexPair = std::pair<graph::VertexId, graph::VertexId>;
+    //dense vertex ids fit 32 bits -> both packed in one 64-bit key, no colliding pairs
+    struct VertexPairHasher {
+        size_t operator()(const VertexPair& vertices) const {
+            return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(vertices.first)) << 32)
+                                       | static_cast<uint32_t>(vertices.second));
+        }
+    };
+    //repeated (from, to) queries skip the search & the route building, cleared by every rebuild
+    ShardedLruCache<VertexPair, RouteStat, VertexPairHasher> route_cache_;
+    
+    //span: stop_pairs model edge, a wait & a ride of span_count spans
+    //board, ride & alight: linear model edges, ride is always one span
+    enum class EdgeType {
+        span,
+        board,
+        ride,
+        alight,
+    };
     
     struct EdgeInfo {
-        BusPtr bus = nullptr;
+        EdgeType type = EdgeType::span;
+        std::string_view bus_name = {};
         int span_count = 0;
         double time = 0.0;
         std::string_view from = {};
         std::string_view to = {};
+        //ridden road distance in meters, time is computed from it
+        double distance = 0.0;
+        //ride edges: road distance from the start of the bus chain to the end of the span
+        double chain_distance = 0.0;
     };
     
     using StopIdMap = std::unordered_map<std::string_view, graph::VertexId>;
     
     StopIdMap stop_ids_;
     std::vector<EdgeInfo> edge_data_;
+    //source of the routes table & names after LoadFromFile
+    std::unique_ptr<MappedFile> mapped_file_ = nullptr;
+    //location of the stop of every vertex, for the astar lower bounds
+    std::vector<geo::EarthPoint> vertex_locations_;
+    //lower bound of road distance / geo distance over all spans, at most 1
+    double road_to_geo_ratio_ = 1.0;
     
-    graph::VertexId FindOrAddStopVertex(std::string_view stop_name);
-    void AddStopsToGraph(BusPtr bus, StopPtr from_stop, auto stops_range);
+    graph::VertexId FindOrAddStopVertex(StopPtr stop);
+    void SetVertexLocation(graph::VertexId vertex, geo::Coord location);
+    void AddStopsToGraph(Graph& bus_graph, BusPtr bus, StopPtr from_stop, auto stops_range);
+    //adds one "on bus" vertex per stop, first_vertex is the id of the first one
+    void AddBusChainToGraph(Graph& bus_graph, BusPtr bus, graph::VertexId first_vertex, auto stops_range);
+    //minutes -> route weight, integer weights are rounded & kept below UNREACHABLE
+    static Weight ToWeight(double minutes);
+    //Ride edge weight of a span ending chain_distance meters down the bus chain
+    Weight GetRideWeight(double chain_distance, double distance) const;
+    static double ToMinutes(Weight weight);
+    double GetTravelTime(StopPtr from, StopPtr to) const;
+    double GetTravelTime(double distance) const;
+    double ComputeRoadToGeoRatio() const;
+    //lower bound of the travel time from vertex to the target vertex
+    double GetTravelTimeLowerBound(graph::VertexId vertex, graph::VertexId target) const;
     
     //writes stop ids into map during graph building
     Graph InitGraphFromDb();
+    Graph InitStopPairsGraph();
+    Graph InitLinearGraph();
+    void InitFromDb();
+    void InitRouter();
+    //new edge weights of the same graph from edge_data_ distances & current settings
+    void ReweightGraph();
+    bool IsStale() const;
+    //rebuilds whatever is stale, once for all concurrent callers
+    void EnsureBuilt();
+    std::optional<RouteInfo> BuildRoute(graph::VertexId from, graph::VertexId to) const;
+    //from the tree cache, if enabled
+    std::shared_ptr<const ShortestPathTree> GetTree(graph::VertexId from) const;
     RouteStat BuildRouteStat(const std::optional<RouteInfo>& info) const;
+    //cached route, build_route() -> std::optional<RouteInfo> is called on a miss only
+    template <typename RouteBuilder>
+    RouteStat PlotCachedRoute(graph::VertexId from, graph::VertexId to, RouteBuilder build_route);
 };